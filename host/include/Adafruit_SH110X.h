@@ -0,0 +1,36 @@
+#ifndef HOST_ADAFRUIT_SH110X_H
+#define HOST_ADAFRUIT_SH110X_H
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SH110X_BLACK 0
+#define SH110X_WHITE 1
+#define SH110X_INVERSE 2
+
+// Host build stand-in for Adafruit_SH1106G: a 1 bpp framebuffer in SH1106
+// page order. begin() and display() talk to the panel model over the fake
+// Wire, so the panel only shows what actually crossed the bus.
+class Adafruit_SH1106G : public Adafruit_GFX {
+private:
+    TwoWire* wire;
+    uint8_t i2caddr = 0x3C;
+    uint8_t* buffer;
+
+    void sendCommand(uint8_t command);
+
+public:
+    Adafruit_SH1106G(uint16_t w, uint16_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1);
+    ~Adafruit_SH1106G();
+
+    bool begin(uint8_t i2caddr = 0x3C, bool reset = true);
+    void display();
+    void clearDisplay();
+    void invertDisplay(bool invert);
+    void setContrast(uint8_t contrast);
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y);
+    uint8_t* getBuffer() { return buffer; }
+};
+
+#endif // HOST_ADAFRUIT_SH110X_H
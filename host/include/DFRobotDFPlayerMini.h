@@ -0,0 +1,60 @@
+#ifndef HOST_DFROBOT_DFPLAYER_MINI_H
+#define HOST_DFROBOT_DFPLAYER_MINI_H
+
+#include <Arduino.h>
+
+#define TimeOut 0
+#define WrongStack 1
+#define DFPlayerCardInserted 2
+#define DFPlayerCardRemoved 3
+#define DFPlayerCardOnline 4
+#define DFPlayerPlayFinished 5
+#define DFPlayerError 6
+#define DFPlayerUSBInserted 7
+#define DFPlayerUSBRemoved 8
+#define DFPlayerUSBOnline 9
+#define DFPlayerCardUSBOnline 10
+#define DFPlayerFeedBack 11
+
+// Host build stand-in for the DFRobotDFPlayerMini library. Like the real one
+// it encodes every call as a 10 byte frame on the serial stream and blocks
+// (in virtual time) for the answer of begin() and the read*() queries, so the
+// DFPlayer model on the other end sees exactly the traffic the device would.
+class DFRobotDFPlayerMini {
+private:
+    static const unsigned long TIMEOUT_MS = 500;
+
+    Stream* serial = nullptr;
+    bool ack = true;
+    bool sending = false;             // Waiting for the ACK of the last command
+    unsigned long sentAt = 0;
+    uint8_t received[10];
+    uint8_t receivedIndex = 0;
+    uint8_t type = 0;
+    uint16_t parameter = 0;
+
+    void sendStack(uint8_t command, uint16_t argument = 0);
+    bool waitAvailable(unsigned long duration);
+    bool parseByte(uint8_t c);
+    int readQuery(uint8_t command);
+
+public:
+    bool begin(Stream& stream, bool isACK = true, bool doReset = true);
+    bool available();
+    uint8_t readType() { return type; }
+    uint16_t read() { return parameter; }
+
+    void play(int fileNumber = 1);
+    void playMp3Folder(int fileNumber);
+    void volume(uint8_t volume);
+    void volumeUp();
+    void volumeDown();
+    void stop();
+    void pause();
+    void start();
+    void reset();
+    int readVolume();
+    int readState();
+};
+
+#endif // HOST_DFROBOT_DFPLAYER_MINI_H
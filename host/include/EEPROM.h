@@ -0,0 +1,62 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <Arduino.h>
+
+#define HOST_FLASH_SECTOR_SIZE 4096
+
+// Counters for the emulated flash, see host_hw.h
+struct EepromStats {
+    unsigned long commits;        // commit() calls that erased and rewrote the sector
+    unsigned long bytesChanged;   // Bytes that differed from flash at commit time
+};
+
+// Host build stand-in for the ESP8266 EEPROM library, with the same
+// semantics: the "EEPROM" is a RAM copy of one flash sector that only exists
+// between begin() and end(). read() returns 0 and write() is ignored without
+// begin(), and nothing reaches flash until commit().
+class EEPROMClass {
+private:
+    uint8_t flash[HOST_FLASH_SECTOR_SIZE];
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    bool dirty = false;
+    EepromStats stats = {};
+
+public:
+    EEPROMClass();
+    ~EEPROMClass();
+
+    void begin(size_t size);
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    bool commit();
+    bool end();
+    size_t length() { return size; }
+    uint8_t* getDataPtr() { dirty = true; return data; }
+
+    template <typename T> T& get(int address, T& value) {
+        if (address < 0 || address + sizeof(T) > size) return value;
+        memcpy(&value, data + address, sizeof(T));
+        return value;
+    }
+
+    template <typename T> const T& put(int address, const T& value) {
+        if (address < 0 || address + sizeof(T) > size) return value;
+        if (memcmp(data + address, &value, sizeof(T)) != 0) {
+            dirty = true;
+            memcpy(data + address, &value, sizeof(T));
+        }
+        return value;
+    }
+
+    // Host side
+    const uint8_t* getFlash() const { return flash; }
+    void eraseFlash();                 // All 0xFF, like a new chip
+    const EepromStats& getStats() const { return stats; }
+    void resetStats() { stats = EepromStats(); }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
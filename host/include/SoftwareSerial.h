@@ -0,0 +1,62 @@
+#ifndef HOST_SOFTWARE_SERIAL_H
+#define HOST_SOFTWARE_SERIAL_H
+
+#include <Arduino.h>
+
+class SoftwareSerial;
+
+// A device model on the other end of a fake UART (host_hw.h)
+class SerialDevice {
+private:
+    friend class SoftwareSerial;
+    SoftwareSerial* port = nullptr;
+
+protected:
+    void reply(uint8_t c);  // Send a byte back to the firmware
+
+public:
+    virtual ~SerialDevice() = default;
+    virtual void serialReceive(uint8_t c) = 0;  // Byte sent by the firmware
+};
+
+// Host build stand-in for SoftwareSerial. Bytes written go straight to the
+// device wired to the same pins, bytes the device sends wait in a receive
+// buffer like the real 64 byte one (and are dropped the same way when full).
+class SoftwareSerial : public Stream {
+private:
+    static const uint8_t RX_BUFFER_SIZE = 64;
+
+    uint8_t rxPin;
+    uint8_t txPin;
+    long baud = 0;
+    SerialDevice* peer = nullptr;
+    const char* linkName = "uart";  // For the bus cost model
+
+    uint8_t rxBuffer[RX_BUFFER_SIZE];
+    uint8_t rxHead = 0;
+    uint8_t rxTail = 0;
+    unsigned long rxOverflows = 0;
+    unsigned long txBytes = 0;
+
+public:
+    SoftwareSerial(uint8_t receivePin, uint8_t transmitPin, bool inverseLogic = false);
+    ~SoftwareSerial();
+
+    void begin(long speed);
+    bool overflow() { bool o = rxOverflows > 0; rxOverflows = 0; return o; }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    // Host side
+    static void connect(uint8_t receivePin, uint8_t transmitPin, SerialDevice* device, const char* name = "uart");
+    void inject(uint8_t c);  // Byte arriving from the device
+    long getBaud() const { return baud; }
+    unsigned long getTxBytes() const { return txBytes; }
+    uint64_t byteNanos() const;  // Start, 8 data and stop bits at the baud rate
+};
+
+#endif // HOST_SOFTWARE_SERIAL_H
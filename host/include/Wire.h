@@ -0,0 +1,76 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 128  // Same as the ESP8266 core
+
+// A device model on the fake I2C bus (host_hw.h attaches them)
+class I2cDevice {
+public:
+    virtual ~I2cDevice() = default;
+    // One write transaction, without the address byte
+    virtual void i2cWrite(const uint8_t* data, size_t length) = 0;
+    // One read transaction, returns the bytes delivered
+    virtual size_t i2cRead(uint8_t* data, size_t length) = 0;
+};
+
+// Transaction counters, see host_hw.h
+struct I2cBusStats {
+    unsigned long writes;       // Write transactions
+    unsigned long reads;        // Read transactions
+    unsigned long bytesWritten; // Payload bytes, without address bytes
+    unsigned long bytesRead;
+    unsigned long nacks;        // Transactions to an address with no device
+};
+
+class TwoWire : public Stream {
+private:
+    static const uint8_t MAX_DEVICES = 8;
+    uint8_t addresses[MAX_DEVICES];
+    I2cDevice* devices[MAX_DEVICES];
+    const char* names[MAX_DEVICES];  // Link names for the bus cost model
+    uint8_t deviceCount = 0;
+
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[BUFFER_LENGTH];
+    size_t txLength = 0;
+    bool transmitting = false;
+
+    uint8_t rxBuffer[BUFFER_LENGTH];
+    size_t rxLength = 0;
+    size_t rxIndex = 0;
+
+    I2cBusStats stats = {};
+    uint32_t clockHz = 100000;  // ESP8266 core default
+
+    int find(uint8_t address);
+    void charge(int device, size_t bytes);
+
+public:
+    void begin() {}
+    void begin(int sda, int scl) { (void)sda; (void)scl; }
+    void setClock(uint32_t frequency) { clockHz = frequency; }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    // Host side
+    void attach(uint8_t address, I2cDevice* device, const char* name = "i2c");
+    uint32_t getClock() const { return clockHz; }
+    void detachAll() { deviceCount = 0; }
+    const I2cBusStats& getStats() const { return stats; }
+    void resetStats() { stats = I2cBusStats(); }
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,204 @@
+#ifndef HOST_HW_H
+#define HOST_HW_H
+
+// Control surface of the host build: virtual time, GPIO/ADC levels, the
+// serial console, and the device models wired to the firmware's buses.
+// Tests and host tools include this; the firmware never does.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SoftwareSerial.h>
+#include <EEPROM.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace host {
+
+// Virtual time. Advancing runs every action scheduled up to the new time,
+// in time order, with the clock set to the action's own time.
+uint64_t nowMicros();
+void advanceMicros(uint64_t us);
+void advanceMillis(unsigned long ms);
+void at(unsigned long ms, std::function<void()> action);  // ms in millis() time
+void resetTime(uint64_t startMicros = 0);
+
+// Heap use of the simulator itself (scheduled actions, device models), which
+// the device does not have. Tools counting the firmware's allocations skip
+// whatever is allocated while inSimulator() is true.
+bool inSimulator();
+class SimulatorScope {
+public:
+    SimulatorScope();
+    ~SimulatorScope();
+};
+
+// GPIO: an input reads its driven level, or its pull-up when not driven.
+// Driving a pin fires an interrupt attached to it on a matching edge.
+void drivePin(uint8_t pin, int level);
+void releasePin(uint8_t pin);
+int getOutput(uint8_t pin);        // Last digitalWrite() level
+void setAnalog(int value);         // A0, 0-1023
+
+// Console: firmware Serial output, and input for Serial.read()
+void serialInput(const char* text);
+void setSerialEcho(bool echo);     // Copy output to stdout (default on)
+const std::string& serialOutput();
+void clearSerialOutput();
+
+// Bus cost model. Every I2C transaction and UART byte is charged its time
+// on the wire: start, stop and 9 bits per byte at the I2C clock, 10 bits
+// per byte at the baud rate. The ESP8266 bit-bangs both buses with the CPU
+// waiting, so that time advances the virtual clock; bytes the firmware
+// receives by interrupt (UART RX) are recorded but not charged.
+struct BusLinkStats {
+    std::string name;            // Subsystem, as wired by HostBoard::connect()
+    unsigned long transactions;  // I2C transactions, UART bytes
+    unsigned long bytes;         // Payload bytes, both directions
+    uint64_t wireNanos;          // Modeled time on the wire
+    uint64_t blockedNanos;       // Of that, time the CPU waited for
+};
+void setBusTiming(bool charge);   // Advance the clock by blocking bus time (default on)
+void setI2cClock(uint32_t hz);    // Override Wire.setClock(), 0 = use it (default)
+void setUartBaud(long baud);      // Override begin()'s baud, 0 = use it (default)
+uint32_t i2cClock(uint32_t firmwareHz);
+long uartBaud(long firmwareBaud);
+void chargeBus(const char* link, size_t bytes, uint64_t nanos, bool blocking);
+const std::vector<BusLinkStats>& busLinks();
+uint64_t blockedBusNanos();       // All links, for per-pass accounting
+void resetBusStats();
+
+} // namespace host
+
+// PCF8574 with a 4x3 key matrix on its quasi-bidirectional pins. Writing 1
+// leaves a pin pulled up weakly, 0 drives it LOW; a pressed key connects
+// its row and column pin, so a LOW on either side reads LOW on both. /INT
+// is LOW while the levels differ from the last read, so it is released by a
+// read; a write that changes the levels (a driven row pulling a held key's
+// column LOW) asserts it again.
+class Pcf8574Keypad : public I2cDevice {
+private:
+    uint8_t rowPins[4];
+    uint8_t colPins[3];
+    const char* layout;      // 12 chars, row by row
+    int intPin;              // Host GPIO of /INT, -1 = not wired
+    uint8_t latch = 0xFF;    // Power-on: all pins pulled up
+    uint8_t lastRead = 0xFF; // Levels as seen by the last port read
+    uint16_t pressed = 0;    // Bit r * 3 + c
+    unsigned long portReads = 0;
+    unsigned long portWrites = 0;
+
+    void updateInterrupt();
+
+public:
+    Pcf8574Keypad(const uint8_t rows[4], const uint8_t cols[3], const char* keyLayout, int interruptPin);
+
+    void i2cWrite(const uint8_t* data, size_t length) override;
+    size_t i2cRead(uint8_t* data, size_t length) override;
+
+    uint8_t levels() const;  // What the port reads right now
+    bool press(char key);    // false if the key is not on the pad
+    bool release(char key);
+    void releaseAll();
+    bool isPressed(char key) const;
+
+    unsigned long getPortReads() const { return portReads; }
+    unsigned long getPortWrites() const { return portWrites; }
+};
+
+// SH1106 controller: decodes the command/data stream into its 132x64 RAM.
+// The visible 128 columns start at the column offset, like on the module.
+class Sh1106Panel : public I2cDevice {
+public:
+    static const uint8_t RAM_COLUMNS = 132;
+    static const uint8_t PAGES = 8;
+
+private:
+    uint8_t ram[PAGES][RAM_COLUMNS];
+    uint8_t columnOffset;
+    uint8_t page = 0;
+    uint8_t column = 0;
+    bool displayOn = false;
+    bool inverted = false;
+    uint8_t pendingArgs = 0;  // Argument bytes still expected by a command
+    unsigned long commandBytes = 0;
+    unsigned long dataBytes = 0;
+    unsigned long dataWrites = 0;   // Data transactions, see getLastDataMillis()
+    unsigned long lastDataMillis = 0;
+
+    void command(uint8_t c);
+
+public:
+    explicit Sh1106Panel(uint8_t visibleColumnOffset);
+
+    void i2cWrite(const uint8_t* data, size_t length) override;
+    size_t i2cRead(uint8_t* data, size_t length) override;
+
+    bool pixel(int16_t x, int16_t y) const;  // Visible coordinates, as lit on the glass
+    uint8_t visibleByte(uint8_t pageIndex, uint8_t x) const;
+    std::string render() const;              // ASCII art, two pixel rows per line
+    bool isOn() const { return displayOn; }
+    bool isInverted() const { return inverted; }
+
+    unsigned long getCommandBytes() const { return commandBytes; }
+    unsigned long getDataBytes() const { return dataBytes; }
+    unsigned long getDataWrites() const { return dataWrites; }
+    unsigned long getLastDataMillis() const { return lastDataMillis; }
+};
+
+// DFPlayer Mini on a UART: decodes the 10 byte frames, records every
+// command with its time, answers ACKs and queries, and reports the end of
+// a track after its (configurable) length, all on virtual time.
+class DfPlayerDevice : public SerialDevice {
+public:
+    struct Command {
+        unsigned long atMs;
+        uint8_t command;
+        uint16_t parameter;
+    };
+
+private:
+    uint8_t frame[10];
+    uint8_t frameIndex = 0;
+    bool present = true;
+    uint8_t volume = 30;
+    uint16_t track = 0;          // Playing track, 0 = idle
+    unsigned long playGeneration = 0;
+    unsigned long badFrames = 0;
+    unsigned long bytesReceived = 0;
+    unsigned long trackMs = 1000;
+    std::vector<Command> log;
+
+    void execute(uint8_t command, bool wantsAck, uint16_t parameter);
+    void send(uint8_t command, uint16_t parameter, unsigned long afterMs);
+
+public:
+    static const unsigned long RESET_MS = 1000;  // Reset until "card online"
+    static const unsigned long REPLY_MS = 20;    // ACK and query answers
+
+    void serialReceive(uint8_t c) override;
+
+    void setPresent(bool isPresent) { present = isPresent; }
+    void setTrackMs(unsigned long ms) { trackMs = ms; }
+    uint8_t getVolume() const { return volume; }
+    uint16_t getTrack() const { return track; }
+    unsigned long getBadFrames() const { return badFrames; }
+    unsigned long getBytesReceived() const { return bytesReceived; }
+    const std::vector<Command>& getLog() const { return log; }
+    void clearLog() { log.clear(); }
+    size_t count(uint8_t command) const;
+};
+
+// The bomb's circuit board, wired with the pins and addresses in config.h
+struct HostBoard {
+    Pcf8574Keypad keypad;
+    Sh1106Panel panel;
+    DfPlayerDevice dfPlayer;
+
+    HostBoard();
+    void connect();  // Attach the devices to Wire and the DFPlayer UART
+};
+
+HostBoard& hostBoard();
+
+#endif // HOST_HW_H
@@ -0,0 +1,77 @@
+// Framebuffer of the Adafruit_SH1106G stand-in
+
+#include <Adafruit_SH110X.h>
+
+Adafruit_SH1106G::Adafruit_SH1106G(uint16_t w, uint16_t h, TwoWire* twi, int8_t rst_pin)
+    : Adafruit_GFX(w, h), wire(twi) {
+    (void)rst_pin;
+    buffer = new uint8_t[w * ((h + 7) / 8)];
+    memset(buffer, 0, w * ((h + 7) / 8));
+}
+
+Adafruit_SH1106G::~Adafruit_SH1106G() {
+    delete[] buffer;
+}
+
+void Adafruit_SH1106G::sendCommand(uint8_t command) {
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    wire->write(command);
+    wire->endTransmission();
+}
+
+// The real driver sends its init list and does not check for an ACK either;
+// here only the commands the panel model cares about
+bool Adafruit_SH1106G::begin(uint8_t addr, bool reset) {
+    (void)reset;
+    i2caddr = addr;
+    clearDisplay();
+    sendCommand(0xAE);  // Display off
+    sendCommand(0xA6);  // Normal (not inverted)
+    sendCommand(0xAF);  // Display on
+    return true;
+}
+
+// Whole frame, page by page, the way the library does it
+void Adafruit_SH1106G::display() {
+    for (uint8_t page = 0; page < HEIGHT / 8; page++) {
+        sendCommand(0xB0 | page);
+        sendCommand(0x02);  // Column 2: the 128 visible of 132
+        sendCommand(0x10);
+        for (int16_t x = 0; x < WIDTH; x += 16) {
+            wire->beginTransmission(i2caddr);
+            wire->write((uint8_t)0x40);
+            wire->write(buffer + page * WIDTH + x, 16);
+            wire->endTransmission();
+        }
+    }
+}
+
+void Adafruit_SH1106G::clearDisplay() {
+    memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SH1106G::invertDisplay(bool invert) {
+    sendCommand(invert ? 0xA7 : 0xA6);
+}
+
+void Adafruit_SH1106G::setContrast(uint8_t contrast) {
+    sendCommand(0x81);
+    sendCommand(contrast);
+}
+
+void Adafruit_SH1106G::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    uint8_t& b = buffer[x + (y / 8) * WIDTH];
+    uint8_t bit = 1 << (y & 7);
+    switch (color) {
+        case SH110X_WHITE: b |= bit; break;
+        case SH110X_BLACK: b &= ~bit; break;
+        case SH110X_INVERSE: b ^= bit; break;
+    }
+}
+
+bool Adafruit_SH1106G::getPixel(int16_t x, int16_t y) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return false;
+    return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+}
@@ -0,0 +1,272 @@
+// Virtual time, GPIO and Serial of the host build (see host_hw.h)
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <map>
+#include "host_hw.h"
+
+namespace {
+
+const uint8_t PIN_COUNT = 32;
+
+struct PinState {
+    uint8_t mode = INPUT;
+    bool driven = false;
+    int drivenLevel = LOW;
+    int outputLevel = LOW;
+    void (*handler)(void) = nullptr;
+    int edgeMode = 0;
+};
+
+uint64_t currentMicros = 0;
+int simulatorDepth = 0;  // SimulatorScope nesting
+std::multimap<uint64_t, std::function<void()>> actions;  // Equal times keep insertion order
+PinState pins[PIN_COUNT];
+int analogValue = 0;
+std::string consoleInput;
+std::string consoleOutput;
+bool consoleEcho = true;
+unsigned long randomState = 1;
+
+int levelOf(const PinState& pin) {
+    if (pin.mode == OUTPUT) return pin.outputLevel;
+    if (pin.driven) return pin.drivenLevel;
+    return (pin.mode == INPUT_PULLUP) ? HIGH : LOW;
+}
+
+void setLevel(uint8_t pin, bool driven, int level) {
+    if (pin >= PIN_COUNT) return;
+    PinState& state = pins[pin];
+    int before = levelOf(state);
+    state.driven = driven;
+    state.drivenLevel = level;
+    int after = levelOf(state);
+    if (before == after || state.handler == nullptr) return;
+
+    bool fire = state.edgeMode == CHANGE ||
+                (state.edgeMode == FALLING && after == LOW) ||
+                (state.edgeMode == RISING && after == HIGH);
+    if (fire) {
+        state.handler();
+    }
+}
+
+} // namespace
+
+namespace host {
+
+uint64_t nowMicros() {
+    return currentMicros;
+}
+
+void advanceMicros(uint64_t us) {
+    uint64_t target = currentMicros + us;
+    while (!actions.empty() && actions.begin()->first <= target) {
+        SimulatorScope scope;
+        auto next = actions.begin();
+        std::function<void()> action = next->second;
+        currentMicros = next->first;
+        actions.erase(next);
+        action();
+    }
+    currentMicros = target;
+}
+
+void advanceMillis(unsigned long ms) {
+    advanceMicros((uint64_t)ms * 1000);
+}
+
+void at(unsigned long ms, std::function<void()> action) {
+    SimulatorScope scope;
+    uint64_t when = (uint64_t)ms * 1000;
+    if (when < currentMicros) when = currentMicros;
+    actions.emplace(when, action);
+}
+
+bool inSimulator() {
+    return simulatorDepth > 0;
+}
+
+SimulatorScope::SimulatorScope() {
+    simulatorDepth++;
+}
+
+SimulatorScope::~SimulatorScope() {
+    simulatorDepth--;
+}
+
+void resetTime(uint64_t startMicros) {
+    actions.clear();
+    currentMicros = startMicros;
+}
+
+void drivePin(uint8_t pin, int level) {
+    setLevel(pin, true, level);
+}
+
+void releasePin(uint8_t pin) {
+    setLevel(pin, false, LOW);
+}
+
+int getOutput(uint8_t pin) {
+    return (pin < PIN_COUNT) ? pins[pin].outputLevel : LOW;
+}
+
+void setAnalog(int value) {
+    analogValue = constrain(value, 0, 1023);
+}
+
+void serialInput(const char* text) {
+    consoleInput += text;
+}
+
+void setSerialEcho(bool echo) {
+    consoleEcho = echo;
+}
+
+const std::string& serialOutput() {
+    return consoleOutput;
+}
+
+void clearSerialOutput() {
+    consoleOutput.clear();
+}
+
+} // namespace host
+
+unsigned long millis() {
+    return (unsigned long)(currentMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)currentMicros;
+}
+
+void delay(unsigned long ms) {
+    host::advanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    host::advanceMicros(us);
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < PIN_COUNT) pins[pin].mode = mode;
+}
+
+int digitalRead(uint8_t pin) {
+    return (pin < PIN_COUNT) ? levelOf(pins[pin]) : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < PIN_COUNT) pins[pin].outputLevel = value ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    return (pin == A0) ? analogValue : 0;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+    if (interrupt >= PIN_COUNT) return;
+    pins[interrupt].handler = handler;
+    pins[interrupt].edgeMode = mode;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    if (interrupt < PIN_COUNT) pins[interrupt].handler = nullptr;
+}
+
+// Deterministic, so host runs repeat exactly
+long random(long maxValue) {
+    if (maxValue <= 0) return 0;
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (long)((randomState >> 16) & 0x7FFF) % maxValue;
+}
+
+long random(long minValue, long maxValue) {
+    if (maxValue <= minValue) return minValue;
+    return minValue + random(maxValue - minValue);
+}
+
+void randomSeed(unsigned long seed) {
+    randomState = seed;
+}
+
+// Print
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::printNumber(unsigned long value, uint8_t base) {
+    char digits[8 * sizeof(unsigned long) + 1];
+    char* p = &digits[sizeof(digits) - 1];
+    *p = '\0';
+    if (base < 2) base = 10;
+    do {
+        unsigned long digit = value % base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value);
+    return write(p);
+}
+
+size_t Print::print(long value, int base) {
+    if (base == 10 && value < 0) {
+        return write((uint8_t)'-') + printNumber((unsigned long)(-value), 10);
+    }
+    return printNumber((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return write(text);
+}
+
+// Serial
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (c == '\r') return 1;  // println() ends lines with "\r\n"
+    consoleOutput += (char)c;
+    if (consoleEcho) {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+int HardwareSerial::available() {
+    return (int)consoleInput.size();
+}
+
+int HardwareSerial::read() {
+    if (consoleInput.empty()) return -1;
+    uint8_t c = consoleInput[0];
+    consoleInput.erase(0, 1);
+    return c;
+}
+
+int HardwareSerial::peek() {
+    return consoleInput.empty() ? -1 : (uint8_t)consoleInput[0];
+}
@@ -0,0 +1,77 @@
+// Bus cost model of the host build: wire time per link, and the virtual
+// clock advanced by the part of it the CPU spends waiting (see host_hw.h)
+
+#include "host_hw.h"
+
+namespace {
+
+bool chargeTime = true;
+uint32_t i2cClockOverride = 0;
+long uartBaudOverride = 0;
+std::vector<host::BusLinkStats> links;
+uint64_t totalBlockedNanos = 0;
+uint64_t pendingNanos = 0;  // Charged time below a whole microsecond, carried over
+
+host::BusLinkStats& linkNamed(const char* name) {
+    for (host::BusLinkStats& link : links) {
+        if (link.name == name) return link;
+    }
+    links.push_back({name, 0, 0, 0, 0});
+    return links.back();
+}
+
+} // namespace
+
+namespace host {
+
+void setBusTiming(bool charge) {
+    chargeTime = charge;
+}
+
+void setI2cClock(uint32_t hz) {
+    i2cClockOverride = hz;
+}
+
+void setUartBaud(long baud) {
+    uartBaudOverride = baud;
+}
+
+uint32_t i2cClock(uint32_t firmwareHz) {
+    return i2cClockOverride ? i2cClockOverride : firmwareHz;
+}
+
+long uartBaud(long firmwareBaud) {
+    return uartBaudOverride ? uartBaudOverride : firmwareBaud;
+}
+
+void chargeBus(const char* link, size_t bytes, uint64_t nanos, bool blocking) {
+    BusLinkStats& stats = linkNamed(link);
+    stats.transactions++;
+    stats.bytes += bytes;
+    stats.wireNanos += nanos;
+    if (!blocking) return;
+
+    stats.blockedNanos += nanos;
+    totalBlockedNanos += nanos;
+    if (chargeTime) {
+        pendingNanos += nanos;
+        uint64_t us = pendingNanos / 1000;
+        pendingNanos %= 1000;
+        if (us) advanceMicros(us);
+    }
+}
+
+const std::vector<BusLinkStats>& busLinks() {
+    return links;
+}
+
+uint64_t blockedBusNanos() {
+    return totalBlockedNanos;
+}
+
+void resetBusStats() {
+    links.clear();
+    totalBlockedNanos = 0;
+}
+
+} // namespace host
@@ -0,0 +1,124 @@
+// Frame level behaviour of the DFRobotDFPlayerMini stand-in, following the
+// real library: 7E FF 06 cmd ack paramH paramL sumH sumL EF
+
+#include <DFRobotDFPlayerMini.h>
+
+namespace {
+
+uint16_t frameChecksum(const uint8_t* frame) {
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < 7; i++) sum += frame[i];
+    return (uint16_t)(0 - sum);
+}
+
+} // namespace
+
+bool DFRobotDFPlayerMini::begin(Stream& stream, bool isACK, bool doReset) {
+    serial = &stream;
+    ack = isACK;
+    type = 0;
+    if (doReset) {
+        reset();
+        waitAvailable(2000);
+        delay(200);
+    } else {
+        type = DFPlayerCardOnline;
+    }
+    return type == DFPlayerCardOnline || type == DFPlayerUSBOnline || !isACK;
+}
+
+// With ACKs on, every command first waits for the ACK of the previous one
+// (or its timeout); without, the library just pauses 10 ms after sending
+void DFRobotDFPlayerMini::sendStack(uint8_t command, uint16_t argument) {
+    if (!serial) return;
+    if (ack) {
+        while (sending) {
+            delay(1);
+            available();
+        }
+    }
+
+    uint8_t frame[10] = {0x7E, 0xFF, 0x06, command, (uint8_t)(ack ? 1 : 0),
+                         (uint8_t)(argument >> 8), (uint8_t)argument, 0, 0, 0xEF};
+    uint16_t sum = frameChecksum(frame);
+    frame[7] = sum >> 8;
+    frame[8] = sum & 0xFF;
+    serial->write(frame, sizeof(frame));
+
+    sentAt = millis();
+    sending = ack;
+    if (!ack) {
+        delay(10);
+    }
+}
+
+bool DFRobotDFPlayerMini::waitAvailable(unsigned long duration) {
+    if (duration == 0) duration = TIMEOUT_MS;
+    unsigned long start = millis();
+    while (!available()) {
+        if (millis() - start >= duration) return false;
+        delay(1);
+    }
+    return true;
+}
+
+bool DFRobotDFPlayerMini::parseByte(uint8_t c) {
+    if (receivedIndex == 0 && c != 0x7E) return false;
+    received[receivedIndex++] = c;
+    if (receivedIndex < 10) return false;
+    receivedIndex = 0;
+
+    uint16_t sum = ((uint16_t)received[7] << 8) | received[8];
+    if (received[9] != 0xEF || sum != frameChecksum(received)) {
+        type = WrongStack;
+        return true;
+    }
+
+    parameter = ((uint16_t)received[5] << 8) | received[6];
+    switch (received[3]) {
+        case 0x41: sending = false; return false;  // ACK
+        case 0x3A: type = (parameter & 0x02) ? DFPlayerCardInserted : DFPlayerUSBInserted; break;
+        case 0x3B: type = (parameter & 0x02) ? DFPlayerCardRemoved : DFPlayerUSBRemoved; break;
+        case 0x3C:
+        case 0x3D: type = DFPlayerPlayFinished; break;
+        case 0x3F: type = (parameter & 0x02) ? DFPlayerCardOnline : DFPlayerUSBOnline; break;
+        case 0x40: type = DFPlayerError; sending = false; break;
+        default: type = DFPlayerFeedBack; break;
+    }
+    return true;
+}
+
+bool DFRobotDFPlayerMini::available() {
+    if (!serial) return false;
+    while (serial->available()) {
+        if (parseByte((uint8_t)serial->read())) {
+            return true;
+        }
+    }
+    if (sending && millis() - sentAt >= TIMEOUT_MS) {
+        sending = false;
+        type = TimeOut;
+        return true;
+    }
+    return false;
+}
+
+int DFRobotDFPlayerMini::readQuery(uint8_t command) {
+    sendStack(command);
+    if (waitAvailable(0)) {
+        return (type == DFPlayerFeedBack) ? parameter : -1;
+    }
+    return -1;
+}
+
+void DFRobotDFPlayerMini::play(int fileNumber) { sendStack(0x03, fileNumber); }
+void DFRobotDFPlayerMini::playMp3Folder(int fileNumber) { sendStack(0x12, fileNumber); }
+void DFRobotDFPlayerMini::volume(uint8_t volume) { sendStack(0x06, volume); }
+void DFRobotDFPlayerMini::volumeUp() { sendStack(0x04); }
+void DFRobotDFPlayerMini::volumeDown() { sendStack(0x05); }
+void DFRobotDFPlayerMini::stop() { sendStack(0x16); }
+void DFRobotDFPlayerMini::pause() { sendStack(0x0E); }
+void DFRobotDFPlayerMini::start() { sendStack(0x0D); }
+void DFRobotDFPlayerMini::reset() { sendStack(0x0C); }
+int DFRobotDFPlayerMini::readVolume() { return readQuery(0x43); }
+int DFRobotDFPlayerMini::readState() { return readQuery(0x42); }
@@ -0,0 +1,62 @@
+// Emulated EEPROM sector of the host build
+
+#include <EEPROM.h>
+
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass() {
+    eraseFlash();
+}
+
+EEPROMClass::~EEPROMClass() {
+    delete[] data;
+}
+
+void EEPROMClass::eraseFlash() {
+    memset(flash, 0xFF, sizeof(flash));
+}
+
+void EEPROMClass::begin(size_t requested) {
+    if (requested == 0 || requested > HOST_FLASH_SECTOR_SIZE) return;
+    requested = (requested + 3) & ~3;  // Word aligned, like the ESP8266 core
+    delete[] data;
+    data = new uint8_t[requested];
+    size = requested;
+    memcpy(data, flash, size);
+    dirty = false;
+}
+
+uint8_t EEPROMClass::read(int address) {
+    if (address < 0 || (size_t)address >= size) return 0;
+    return data[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (address < 0 || (size_t)address >= size) return;
+    if (data[address] != value) {
+        data[address] = value;
+        dirty = true;
+    }
+}
+
+// Flash can only be rewritten a sector at a time: erase, then program
+bool EEPROMClass::commit() {
+    if (size == 0) return false;
+    if (!dirty) return true;
+    for (size_t i = 0; i < size; i++) {
+        if (flash[i] != data[i]) stats.bytesChanged++;
+    }
+    memset(flash, 0xFF, sizeof(flash));
+    memcpy(flash, data, size);
+    stats.commits++;
+    dirty = false;
+    return true;
+}
+
+bool EEPROMClass::end() {
+    bool ok = commit();
+    delete[] data;
+    data = nullptr;
+    size = 0;
+    return ok;
+}
@@ -0,0 +1,20 @@
+// HAL of the host build (see include/hal.h)
+
+#include "hal.h"
+#include <chrono>
+
+// Real time, not virtual time: the profiler measures what the code costs on
+// this machine. One "cycle" is one nanosecond.
+uint32_t halCycleCount() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t halCpuMHz() {
+    return 1000;
+}
+
+void halRestart() {
+    fprintf(stderr, "ESP.restart() requested at %lu ms\n", millis());
+    exit(3);
+}
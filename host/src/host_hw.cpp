@@ -0,0 +1,273 @@
+// Device models of the host build (see host_hw.h)
+
+#include "host_hw.h"
+#include "config.h"
+
+// Pcf8574Keypad
+
+Pcf8574Keypad::Pcf8574Keypad(const uint8_t rows[4], const uint8_t cols[3], const char* keyLayout, int interruptPin)
+    : layout(keyLayout), intPin(interruptPin) {
+    memcpy(rowPins, rows, sizeof(rowPins));
+    memcpy(colPins, cols, sizeof(colPins));
+}
+
+// A LOW spreads through every pressed key: pins joined by keys form one net,
+// and the net reads LOW if any of its pins is driven LOW
+uint8_t Pcf8574Keypad::levels() const {
+    uint8_t low = ~latch;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint8_t r = 0; r < 4; r++) {
+            for (uint8_t c = 0; c < 3; c++) {
+                if (!(pressed & (1 << (r * 3 + c)))) continue;
+                uint8_t net = (1 << rowPins[r]) | (1 << colPins[c]);
+                if ((low & net) && (low & net) != net) {
+                    low |= net;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return ~low;
+}
+
+void Pcf8574Keypad::updateInterrupt() {
+    if (intPin < 0) return;
+    if (levels() != lastRead) host::drivePin(intPin, LOW);
+    else host::releasePin(intPin);  // Open drain, the MCU pull-up takes it HIGH
+}
+
+void Pcf8574Keypad::i2cWrite(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        latch = data[i];
+        portWrites++;
+    }
+    updateInterrupt();
+}
+
+size_t Pcf8574Keypad::i2cRead(uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = levels();
+        portReads++;
+    }
+    lastRead = levels();
+    updateInterrupt();
+    return length;
+}
+
+bool Pcf8574Keypad::press(char key) {
+    const char* at = strchr(layout, key);
+    if (key == '\0' || at == nullptr) return false;
+    pressed |= 1 << (at - layout);
+    updateInterrupt();
+    return true;
+}
+
+bool Pcf8574Keypad::release(char key) {
+    const char* at = strchr(layout, key);
+    if (key == '\0' || at == nullptr) return false;
+    pressed &= ~(1 << (at - layout));
+    updateInterrupt();
+    return true;
+}
+
+void Pcf8574Keypad::releaseAll() {
+    pressed = 0;
+    updateInterrupt();
+}
+
+bool Pcf8574Keypad::isPressed(char key) const {
+    const char* at = strchr(layout, key);
+    return key != '\0' && at != nullptr && (pressed & (1 << (at - layout)));
+}
+
+// Sh1106Panel
+
+Sh1106Panel::Sh1106Panel(uint8_t visibleColumnOffset) : columnOffset(visibleColumnOffset) {
+    memset(ram, 0, sizeof(ram));
+}
+
+void Sh1106Panel::command(uint8_t c) {
+    commandBytes++;
+    if (pendingArgs > 0) {
+        pendingArgs--;
+        return;
+    }
+    if (c >= 0xB0 && c <= 0xB7) page = c & 0x07;
+    else if (c <= 0x0F) column = (column & 0xF0) | c;
+    else if (c >= 0x10 && c <= 0x1F) column = (column & 0x0F) | ((c & 0x0F) << 4);
+    else if (c == 0xAE || c == 0xAF) displayOn = (c == 0xAF);
+    else if (c == 0xA6 || c == 0xA7) inverted = (c == 0xA7);
+    else if (c == 0x81 || c == 0xA8 || c == 0xAD || c == 0xD3 || c == 0xD5 ||
+             c == 0xD9 || c == 0xDA || c == 0xDB || c == 0xDC) pendingArgs = 1;
+}
+
+// First byte is the control byte: 0x00 command stream, 0x40 data stream
+void Sh1106Panel::i2cWrite(const uint8_t* data, size_t length) {
+    if (length == 0) return;
+    if (data[0] == 0x40) {
+        for (size_t i = 1; i < length; i++) {
+            if (column < RAM_COLUMNS) ram[page][column] = data[i];
+            column++;
+            dataBytes++;
+        }
+        dataWrites++;
+        lastDataMillis = millis();
+    } else {
+        for (size_t i = 1; i < length; i++) command(data[i]);
+    }
+}
+
+size_t Sh1106Panel::i2cRead(uint8_t* data, size_t length) {
+    memset(data, 0, length);  // Status byte, never busy
+    return length;
+}
+
+uint8_t Sh1106Panel::visibleByte(uint8_t pageIndex, uint8_t x) const {
+    uint16_t ramColumn = x + columnOffset;
+    if (pageIndex >= PAGES || ramColumn >= RAM_COLUMNS) return 0;
+    return ram[pageIndex][ramColumn];
+}
+
+bool Sh1106Panel::pixel(int16_t x, int16_t y) const {
+    if (!displayOn || x < 0 || y < 0 || y >= PAGES * 8) return false;
+    bool lit = visibleByte(y / 8, x) & (1 << (y & 7));
+    return lit != inverted;
+}
+
+std::string Sh1106Panel::render() const {
+    std::string text;
+    for (int16_t y = 0; y < PAGES * 8; y += 2) {
+        for (int16_t x = 0; x < RAM_COLUMNS - 2 * columnOffset; x++) {
+            bool top = pixel(x, y);
+            bool bottom = pixel(x, y + 1);
+            text += top ? (bottom ? '#' : '\'') : (bottom ? '.' : ' ');
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+// DfPlayerDevice
+
+void DfPlayerDevice::serialReceive(uint8_t c) {
+    host::SimulatorScope scope;  // The command log grows
+    bytesReceived++;
+    if (frameIndex == 0 && c != 0x7E) {
+        badFrames++;
+        return;
+    }
+    frame[frameIndex++] = c;
+    if (frameIndex < 10) return;
+    frameIndex = 0;
+
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < 7; i++) sum += frame[i];
+    uint16_t expected = ((uint16_t)frame[7] << 8) | frame[8];
+    if (frame[1] != 0xFF || frame[2] != 0x06 || frame[9] != 0xEF || (uint16_t)(sum + expected) != 0) {
+        badFrames++;
+        return;
+    }
+
+    uint16_t parameter = ((uint16_t)frame[5] << 8) | frame[6];
+    log.push_back({millis(), frame[3], parameter});
+    if (present) {
+        execute(frame[3], frame[4] != 0, parameter);
+    }
+}
+
+void DfPlayerDevice::send(uint8_t command, uint16_t parameter, unsigned long afterMs) {
+    host::at(millis() + afterMs, [this, command, parameter]() {
+        uint8_t out[10] = {0x7E, 0xFF, 0x06, command, 0x00,
+                           (uint8_t)(parameter >> 8), (uint8_t)parameter, 0, 0, 0xEF};
+        uint16_t sum = 0;
+        for (uint8_t i = 1; i < 7; i++) sum += out[i];
+        sum = 0 - sum;
+        out[7] = sum >> 8;
+        out[8] = sum & 0xFF;
+        for (uint8_t i = 0; i < 10; i++) reply(out[i]);
+    });
+}
+
+void DfPlayerDevice::execute(uint8_t command, bool wantsAck, uint16_t parameter) {
+    if (wantsAck) {
+        send(0x41, 0, REPLY_MS);
+    }
+
+    switch (command) {
+        case 0x03:  // Play track
+        case 0x12: {
+            track = parameter;
+            unsigned long generation = ++playGeneration;
+            host::at(millis() + trackMs, [this, generation]() {
+                if (generation != playGeneration || track == 0) return;
+                send(0x3D, track, 0);
+                track = 0;
+            });
+            break;
+        }
+        case 0x06:  // Volume
+            volume = (parameter > 30) ? 30 : parameter;
+            break;
+        case 0x04:
+            if (volume < 30) volume++;
+            break;
+        case 0x05:
+            if (volume > 0) volume--;
+            break;
+        case 0x0E:  // Pause
+        case 0x16:  // Stop
+            track = 0;
+            playGeneration++;
+            break;
+        case 0x0C:  // Reset: the card reports online once the module booted
+            track = 0;
+            playGeneration++;
+            send(0x3F, 0x02, RESET_MS);
+            break;
+        case 0x42:  // Query status
+            send(0x42, track ? 0x0201 : 0x0200, REPLY_MS);
+            break;
+        case 0x43:  // Query volume
+            send(0x43, volume, REPLY_MS);
+            break;
+    }
+}
+
+size_t DfPlayerDevice::count(uint8_t command) const {
+    size_t n = 0;
+    for (const Command& entry : log) {
+        if (entry.command == command) n++;
+    }
+    return n;
+}
+
+// HostBoard
+
+namespace {
+
+const uint8_t KEYPAD_ROWS[4] = {PIN_ROW1, PIN_ROW2, PIN_ROW3, PIN_ROW4};
+const uint8_t KEYPAD_COLS[3] = {PIN_COL1, PIN_COL2, PIN_COL3};
+
+// SoundManager opens SoftwareSerial(5, 4)
+const uint8_t DFPLAYER_UART_RX = 5;
+const uint8_t DFPLAYER_UART_TX = 4;
+
+} // namespace
+
+HostBoard::HostBoard()
+    : keypad(KEYPAD_ROWS, KEYPAD_COLS, "123456789*0#", KEYPAD_USE_INTERRUPT ? PIN_KEYPAD_INT : -1),
+      panel(SH1106_COLUMN_OFFSET) {
+}
+
+void HostBoard::connect() {
+    Wire.attach(PCF8574_ADDRESS, &keypad, "keypad");
+    Wire.attach(OLED_I2C_ADDRESS, &panel, "display");
+    SoftwareSerial::connect(DFPLAYER_UART_RX, DFPLAYER_UART_TX, &dfPlayer, "dfplayer");
+}
+
+HostBoard& hostBoard() {
+    static HostBoard board;
+    return board;
+}
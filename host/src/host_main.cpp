@@ -0,0 +1,142 @@
+// Runs the firmware headless on the host: setup(), then loop() until the
+// requested amount of virtual time has passed, then a summary of what the
+// devices saw and how long the buses kept the CPU waiting.
+//
+//   airsoft_bomb [--ms N] [--quiet] [--i2c-hz N] [--baud N] [--no-bus-time]
+//                [--keys MS:KEYS]... [--serial MS:TEXT]...
+//     --i2c-hz, --baud   bus speeds for the cost model instead of the firmware's
+//     --no-bus-time      record bus time without advancing the clock by it
+//     --keys             type KEYS on the keypad from MS after setup(), one
+//                        key every HOST_KEY_STEP_MS, each held HOST_KEY_HOLD_MS
+//     --serial           send TEXT to the console MS after setup(), e.g. "l"
+//
+// With LATENCY_TRACE_ENABLED (env:native_trace) the run ends with the
+// press -> beep/pixel latency report.
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "host_hw.h"
+#include "latency_tracer.h"
+
+#define HOST_KEY_STEP_MS 150  // Typing pace of --keys
+#define HOST_KEY_HOLD_MS 60
+
+namespace {
+
+struct ScriptedInput {
+    unsigned long afterSetupMs;
+    bool serial;       // Console text, else keypad keys
+    std::string text;
+};
+
+// "MS:TEXT"
+bool parseInput(const char* arg, bool serial, std::vector<ScriptedInput>& inputs) {
+    char* rest = nullptr;
+    unsigned long ms = strtoul(arg, &rest, 10);
+    if (rest == arg || *rest != ':' || rest[1] == '\0') return false;
+    inputs.push_back({ms, serial, rest + 1});
+    return true;
+}
+
+void schedule(const ScriptedInput& input, unsigned long startMs) {
+    unsigned long at = startMs + input.afterSetupMs;
+    if (input.serial) {
+        std::string text = input.text;
+        host::at(at, [text]() { host::serialInput(text.c_str()); });
+        return;
+    }
+    for (char key : input.text) {
+        host::at(at, [key]() { hostBoard().keypad.press(key); });
+        host::at(at + HOST_KEY_HOLD_MS, [key]() { hostBoard().keypad.release(key); });
+        at += HOST_KEY_STEP_MS;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned long runMs = 10000;
+    std::vector<ScriptedInput> inputs;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ms") == 0 && i + 1 < argc) {
+            runMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            host::setSerialEcho(false);
+        } else if (strcmp(argv[i], "--i2c-hz") == 0 && i + 1 < argc) {
+            host::setI2cClock(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            host::setUartBaud(strtol(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--no-bus-time") == 0) {
+            host::setBusTiming(false);
+        } else if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc && parseInput(argv[i + 1], false, inputs)) {
+            i++;
+        } else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc && parseInput(argv[i + 1], true, inputs)) {
+            i++;
+        } else {
+            fprintf(stderr, "usage: %s [--ms N] [--quiet] [--i2c-hz N] [--baud N] [--no-bus-time] "
+                            "[--keys MS:KEYS]... [--serial MS:TEXT]...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    HostBoard& board = hostBoard();
+    board.connect();
+
+    setup();
+    for (const ScriptedInput& input : inputs) {
+        schedule(input, millis());
+    }
+    uint64_t setupBusNanos = host::blockedBusNanos();
+
+    // Per loop() pass: virtual time taken, and how much of it was bus waits
+    unsigned long passes = 0;
+    uint64_t passMicros = 0;
+    uint64_t maxPassMicros = 0;
+    uint64_t maxPassBusNanos = 0;
+    uint64_t loopStart = host::nowMicros();
+    uint64_t end = loopStart + (uint64_t)runMs * 1000;
+    while (host::nowMicros() < end) {
+        uint64_t before = host::nowMicros();
+        uint64_t busBefore = host::blockedBusNanos();
+        loop();
+        if (host::nowMicros() == before) {
+            host::advanceMicros(1);  // A pass is never free on the device either
+        }
+        uint64_t took = host::nowMicros() - before;
+        uint64_t bus = host::blockedBusNanos() - busBefore;
+        passes++;
+        passMicros += took;
+        if (took > maxPassMicros) maxPassMicros = took;
+        if (bus > maxPassBusNanos) maxPassBusNanos = bus;
+    }
+
+    const I2cBusStats& bus = Wire.getStats();
+    printf("\n--- host run: %lu ms virtual time ---\n", millis());
+    printf("%s", board.panel.render().c_str());
+    printf("i2c: %lu writes (%lu bytes), %lu reads (%lu bytes), %lu nacks\n",
+           bus.writes, bus.bytesWritten, bus.reads, bus.bytesRead, bus.nacks);
+    printf("panel: %lu data bytes, %lu command bytes\n",
+           board.panel.getDataBytes(), board.panel.getCommandBytes());
+    printf("dfplayer: %u commands, volume %u, bad frames %lu\n",
+           (unsigned)board.dfPlayer.getLog().size(), board.dfPlayer.getVolume(), board.dfPlayer.getBadFrames());
+    printf("eeprom: %lu commits\n", EEPROM.getStats().commits);
+
+    uint64_t runMicros = host::nowMicros();
+    printf("bus time, i2c at %lu Hz:\n", (unsigned long)host::i2cClock(Wire.getClock()));
+    for (const host::BusLinkStats& link : host::busLinks()) {
+        printf("  %-9s %8lu xfers %8lu bytes %10.1f ms wire %10.1f ms waited (%4.1f%% of the run)\n",
+               link.name.c_str(), link.transactions, link.bytes, link.wireNanos / 1e6, link.blockedNanos / 1e6,
+               runMicros ? link.blockedNanos / 10.0 / runMicros : 0.0);
+    }
+    uint64_t loopBusNanos = host::blockedBusNanos() - setupBusNanos;
+    printf("loop: %lu passes, %.1f us avg (%.1f us bus), max %llu us (%.1f us bus)\n", passes,
+           passes ? (double)passMicros / passes : 0.0, passes ? loopBusNanos / 1000.0 / passes : 0.0,
+           (unsigned long long)maxPassMicros, maxPassBusNanos / 1000.0);
+
+#if LATENCY_TRACE_ENABLED
+    host::setSerialEcho(true);
+    LatencyTracer::printReport(Serial);
+#endif
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Fake UART of the host build: bytes go straight to the device model wired
+// to the same pins with SoftwareSerial::connect() (see host_hw.h)
+
+#include <SoftwareSerial.h>
+#include "host_hw.h"
+
+namespace {
+
+struct SerialWiring {
+    uint8_t rxPin;
+    uint8_t txPin;
+    SerialDevice* device;
+    const char* name;
+};
+
+const uint8_t MAX_WIRINGS = 4;
+SerialWiring wirings[MAX_WIRINGS];
+uint8_t wiringCount = 0;
+
+} // namespace
+
+void SerialDevice::reply(uint8_t c) {
+    if (port) port->inject(c);
+}
+
+void SoftwareSerial::connect(uint8_t receivePin, uint8_t transmitPin, SerialDevice* device, const char* name) {
+    for (uint8_t i = 0; i < wiringCount; i++) {
+        if (wirings[i].rxPin == receivePin && wirings[i].txPin == transmitPin) {
+            wirings[i].device = device;
+            wirings[i].name = name;
+            return;
+        }
+    }
+    if (wiringCount < MAX_WIRINGS) {
+        wirings[wiringCount++] = {receivePin, transmitPin, device, name};
+    }
+}
+
+SoftwareSerial::SoftwareSerial(uint8_t receivePin, uint8_t transmitPin, bool inverseLogic)
+    : rxPin(receivePin), txPin(transmitPin) {
+    (void)inverseLogic;
+}
+
+SoftwareSerial::~SoftwareSerial() {
+    if (peer && peer->port == this) peer->port = nullptr;
+}
+
+void SoftwareSerial::begin(long speed) {
+    baud = speed;
+    for (uint8_t i = 0; i < wiringCount; i++) {
+        if (wirings[i].rxPin == rxPin && wirings[i].txPin == txPin) {
+            peer = wirings[i].device;
+            peer->port = this;
+            linkName = wirings[i].name;
+        }
+    }
+}
+
+uint64_t SoftwareSerial::byteNanos() const {
+    return 10 * 1000000000ULL / host::uartBaud(baud);
+}
+
+// Sending bit-bangs the whole byte with interrupts off, the CPU waits
+size_t SoftwareSerial::write(uint8_t c) {
+    if (baud == 0) return 0;
+    txBytes++;
+    host::chargeBus(linkName, 1, byteNanos(), true);
+    if (peer) peer->serialReceive(c);
+    return 1;
+}
+
+// Received bytes come in by interrupt, only recorded
+void SoftwareSerial::inject(uint8_t c) {
+    if (baud) host::chargeBus(linkName, 1, byteNanos(), false);
+    uint8_t next = (rxTail + 1) % RX_BUFFER_SIZE;
+    if (next == rxHead) {
+        rxOverflows++;
+        return;
+    }
+    rxBuffer[rxTail] = c;
+    rxTail = next;
+}
+
+int SoftwareSerial::available() {
+    return (rxTail + RX_BUFFER_SIZE - rxHead) % RX_BUFFER_SIZE;
+}
+
+int SoftwareSerial::read() {
+    if (rxHead == rxTail) return -1;
+    uint8_t c = rxBuffer[rxHead];
+    rxHead = (rxHead + 1) % RX_BUFFER_SIZE;
+    return c;
+}
+
+int SoftwareSerial::peek() {
+    return (rxHead == rxTail) ? -1 : rxBuffer[rxHead];
+}
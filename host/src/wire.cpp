@@ -0,0 +1,101 @@
+// Fake I2C bus of the host build: transactions are delivered to the device
+// models attached with TwoWire::attach() (see host_hw.h)
+
+#include <Wire.h>
+#include "host_hw.h"
+
+TwoWire Wire;
+
+int TwoWire::find(uint8_t address) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (addresses[i] == address) return i;
+    }
+    return -1;
+}
+
+void TwoWire::attach(uint8_t address, I2cDevice* device, const char* name) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (addresses[i] == address) {
+            devices[i] = device;
+            names[i] = name;
+            return;
+        }
+    }
+    if (deviceCount < MAX_DEVICES) {
+        addresses[deviceCount] = address;
+        names[deviceCount] = name;
+        devices[deviceCount++] = device;
+    }
+}
+
+// Start, address byte, payload (9 bits a byte with the ACK), stop
+void TwoWire::charge(int device, size_t bytes) {
+    uint64_t bits = 1 + 9 * (1 + bytes) + 1;
+    uint64_t nanos = bits * 1000000000ULL / host::i2cClock(clockHz);
+    host::chargeBus(device < 0 ? "i2c" : names[device], bytes, nanos, true);
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address;
+    txLength = 0;
+    transmitting = true;
+}
+
+// Same return codes as the ESP8266 core: 0 ok, 2 address NACK
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    transmitting = false;
+    int device = find(txAddress);
+    if (device < 0) {
+        charge(device, 0);  // The address byte still goes out
+        stats.nacks++;
+        return 2;
+    }
+    charge(device, txLength);
+    stats.writes++;
+    stats.bytesWritten += txLength;
+    devices[device]->i2cWrite(txBuffer, txLength);
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop) {
+    (void)sendStop;
+    rxIndex = 0;
+    rxLength = 0;
+    int device = find(address);
+    if (device < 0) {
+        charge(device, 0);
+        stats.nacks++;
+        return 0;
+    }
+    if (quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+    charge(device, quantity);
+    rxLength = devices[device]->i2cRead(rxBuffer, quantity);
+    stats.reads++;
+    stats.bytesRead += rxLength;
+    return (uint8_t)rxLength;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (!transmitting || txLength >= BUFFER_LENGTH) return 0;
+    txBuffer[txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t length) {
+    size_t n = 0;
+    while (n < length && write(data[n])) n++;
+    return n;
+}
+
+int TwoWire::available() {
+    return (int)(rxLength - rxIndex);
+}
+
+int TwoWire::read() {
+    return (rxIndex < rxLength) ? rxBuffer[rxIndex++] : -1;
+}
+
+int TwoWire::peek() {
+    return (rxIndex < rxLength) ? rxBuffer[rxIndex] : -1;
+}
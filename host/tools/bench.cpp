@@ -0,0 +1,411 @@
+// Micro-benchmarks for the hot paths of the 10 ms loop, on the host build:
+// every DisplayManager::show* screen, centering text (getTextBounds() against
+// the text_layout.h metrics), the keypad scan against the PCF8574
+// model, and a game step of both modes (update alone, and update + render
+// when the game asks for a frame, as the render task does).
+//
+//   bench [options]
+//     --filter TEXT       only benchmarks whose name contains TEXT
+//     --scale F           multiply the iteration counts (default 1)
+//     --save FILE         write the results as a baseline
+//     --baseline FILE     compare against a baseline, exit 1 on a regression
+//     --tolerance PCT     allowed ns/op increase over the baseline (default 25)
+//
+// Exits 1 when a screen or frame allocated, see mustNotAllocate().
+// Iteration counts are fixed, so allocations and bus bytes per op are exact
+// and compared strictly; ns/op depends on the machine and gets the tolerance.
+// Allocations the simulator makes for itself (scheduled actions, the device
+// models, see host::inSimulator()) are not counted: the device has none of
+// them. Screens and game frames must not allocate at all and fail on any
+// allocation, with or without a baseline.
+// Bus time per op is the modeled wire time the CPU waits for (host_hw.h),
+// at the firmware's bus speeds. It is recorded, not added to virtual time,
+// so every op sees the same device timing.
+// Baseline lines: <name> <ns/op> <allocs/op> <i2c bytes/op> <uart bytes/op> <bus us/op>
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "host_hw.h"
+#include "clock.h"
+#include "display_manager.h"
+#include "game_modes.h"
+#include "keypad_manager.h"
+#include "sound_manager.h"
+#include "text_layout.h"
+
+// Every heap allocation of the process goes through here, so a benchmark
+// can tell how many its operation made
+namespace {
+unsigned long allocationCount = 0;
+}
+
+void* operator new(size_t size) {
+    if (!host::inSimulator()) allocationCount++;
+    if (void* block = malloc(size ? size : 1)) return block;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* block) noexcept { free(block); }
+void operator delete[](void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { free(block); }
+void operator delete[](void* block, size_t) noexcept { free(block); }
+
+namespace {
+
+struct Result {
+    std::string name;
+    unsigned long allocations;  // In the timed loop
+    double nsPerOp;
+    double allocsPerOp;
+    double i2cBytesPerOp;
+    double uartBytesPerOp;
+    double busMicrosPerOp;
+};
+
+struct Benchmark {
+    const char* name;
+    unsigned long iterations;
+    std::function<void()> setup;            // Untimed, before the loop
+    std::function<void(unsigned long)> op;  // One operation, gets the iteration
+};
+
+// The firmware's devices, brought up once like setup() does
+struct Rig {
+    DisplayManager display;
+    SoundManager sound;
+    KeypadManager keypad;
+    ManualClock clock{0};
+    DefuseMode defuse;
+    DominationMode domination;
+
+    void init() {
+        hostBoard().connect();
+        display.init();
+        sound.init();
+        keypad.init();
+        defuse.setManagers(&display, &sound);
+        domination.setManagers(&display, &sound);
+        defuse.setClock(&clock);
+        domination.setClock(&clock);
+    }
+
+    // Armed with a fuse far longer than any run
+    void armDefuse() {
+        defuse.init();
+        defuse.setTimeLimit(36000);
+        clock.set(host::nowMicros() / 1000);
+        defuse.tick(clock.now());
+        for (char key : std::string("1234#")) defuse.handleButton(key);
+    }
+
+    // Running, at the longest match so it outlasts the benchmark
+    void startDomination() {
+        domination.init();
+        while (domination.getGameTime() < DOM_MAX_TIME * 60) domination.setupGameTime(true);
+        clock.set(host::nowMicros() / 1000);
+        domination.tick(clock.now());
+        domination.handleButton('#');
+    }
+
+    // One GAME_TICK_MS step of virtual time for the game and the devices
+    void step() {
+        host::advanceMillis(GAME_TICK_MS);
+        clock.set(host::nowMicros() / 1000);
+    }
+
+    // Team button traffic: red and green take turns holding for 1.5 s, so
+    // the point changes hands every few hundred steps
+    void teamButtons(unsigned long i) {
+        unsigned long phase = i % 300;
+        domination.updateButtonStates(phase < 150, phase >= 150);
+    }
+};
+
+Rig rig;
+
+// Labels of the show* screens, with their text size, for the layout ops
+struct CenteredText {
+    TextLabel label;
+    uint8_t size;
+};
+const CenteredText CENTERED_TEXTS[] = {
+    {"AIRSOFT BOMB", 2}, {"READY", 1}, {"Press any key", 1}, {"GAME MODE", 1}, {"DEFUSE BOMB", 2},
+    {"Plant/defuse mission", 1}, {"COUNTDOWN", 1}, {"RED LEAD", 2}, {"ENTER CODE", 1}, {"ARMED", 2},
+};
+Adafruit_SH1106G layoutPanel(SCREEN_WIDTH, SCREEN_HEIGHT);  // Only measures, never drawn
+volatile int16_t layoutSink;  // Keeps the computed x from being optimized away
+
+std::vector<Benchmark> benchmarks() {
+    static const char* const menuItems[] = {"DEFUSE", "DOMINATION", "SETTINGS", "BATTERY"};
+    DisplayManager& d = rig.display;
+    std::vector<Benchmark> list;
+
+    // Screens alternate their arguments so each flush has real changes to send
+    list.push_back({"display/showWelcome", 20000, nullptr, [&d](unsigned long) { d.showWelcome(); }});
+    list.push_back({"display/showMenu", 20000, nullptr,
+                    [&d](unsigned long i) { d.showMenu("MAIN MENU", menuItems, 4, i % 4); }});
+    list.push_back({"display/showGameMode", 20000, nullptr,
+                    [&d](unsigned long i) { d.showGameMode((i & 1) ? DOMINATION_MODE : DEFUSE_MODE); }});
+    list.push_back({"display/showCountdown", 20000, nullptr,
+                    [&d](unsigned long i) { d.showCountdown(3600 - i % 3600); }});
+    list.push_back({"display/showDefuseScreen", 20000, nullptr,
+                    [&d](unsigned long i) { d.showDefuseScreen(3600 - i % 3600, true, (i & 1) ? "12" : "123"); }});
+    list.push_back({"display/showDominationScreen/3", 20000, nullptr,
+                    [&d](unsigned long i) { d.showDominationScreen(i % 100, (i / 2) % 100, 100); }});
+    list.push_back({"display/showGameOver", 20000, nullptr, [&d](unsigned long i) { d.showGameOver(i & 1); }});
+    list.push_back({"display/showSettings", 20000, nullptr,
+                    [&d](unsigned long i) { d.showSettings("VOLUME", (i & 1) ? "20" : "25"); }});
+    list.push_back({"display/showPassword", 20000, nullptr,
+                    [&d](unsigned long i) { d.showPassword((i & 1) ? "1234" : "123", i & 2); }});
+    list.push_back({"display/showBatteryStatus", 20000, nullptr,
+                    [&d](unsigned long i) { d.showBatteryStatus(3.3f + (i % 10) * 0.1f); }});
+    list.push_back({"display/showError", 20000, nullptr,
+                    [&d](unsigned long i) { d.showError((i & 1) ? "NO SD CARD" : "LOW BATTERY"); }});
+    list.push_back({"display/showDominationSetup", 20000, nullptr,
+                    [&d](unsigned long i) { d.showDominationSetup(5 + (i % 12) * 5); }});
+    list.push_back({"display/showDominationScreen/5", 20000, nullptr, [&d](unsigned long i) {
+                        d.showDominationScreen(i % 1000, (i / 3) % 1000, (i * 7) % 101,
+                                               (PointOwnership)(i % 3), 3600 - i % 3600);
+                    }});
+    list.push_back({"display/showDominationGameOver", 20000, nullptr, [&d](unsigned long i) {
+                        d.showDominationGameOver((PointOwnership)(i % 3), i % 1000, 999 - i % 1000);
+                    }});
+    list.push_back({"display/update/unchanged", 50000, [&d]() { d.showWelcome(); },
+                    [&d](unsigned long) { d.update(); }});
+    list.push_back({"display/update/full", 5000, [&d]() { d.showWelcome(); }, [&d](unsigned long) {
+                        d.invalidate();
+                        d.update();
+                    }});
+
+    // Left edges of all the labels, the way showCenteredText() used to find
+    // them and the two ways it does now
+    list.push_back({"layout/center/getTextBounds", 20000, nullptr, [](unsigned long) {
+                        for (const CenteredText& t : CENTERED_TEXTS) {
+                            int16_t x1, y1;
+                            uint16_t w, h;
+                            layoutPanel.setTextSize(t.size);
+                            layoutPanel.getTextBounds(t.label.text, 0, 0, &x1, &y1, &w, &h);
+                            layoutSink = (SCREEN_WIDTH - w) / 2;
+                        }
+                    }});
+    list.push_back({"layout/center/strlen", 20000, nullptr, [](unsigned long) {
+                        for (const CenteredText& t : CENTERED_TEXTS) {
+                            layoutSink = centeredTextX(strlen(t.label.text), t.size);
+                        }
+                    }});
+    list.push_back({"layout/center/label", 20000, nullptr, [](unsigned long) {
+                        for (const CenteredText& t : CENTERED_TEXTS) {
+                            layoutSink = t.label.centeredX(t.size);
+                        }
+                    }});
+
+    // Every call is a sample (1 ms apart), a key goes down and up every 100
+    list.push_back({"keypad/scan/idle", 50000, []() { hostBoard().keypad.releaseAll(); }, [](unsigned long) {
+                        host::advanceMillis(1);
+                        rig.keypad.scanKeypad();
+                    }});
+    list.push_back({"keypad/scan/typing", 50000, nullptr, [](unsigned long i) {
+                        Pcf8574Keypad& pad = hostBoard().keypad;
+                        if (i % 100 == 0) pad.press("0123456789*#"[(i / 100) % 12]);
+                        else if (i % 100 == 50) pad.releaseAll();
+                        host::advanceMillis(1);
+                        rig.keypad.scanKeypad();
+                        KeyEvent event;
+                        while (rig.keypad.getEvents().pop(event)) {}
+                    }});
+
+    // One beep from play() until the sound task has sent the last frame byte
+    // (spaced out so the arbiter neither merges nor drops them)
+    list.push_back({"sound/beep", 2000, nullptr, [](unsigned long) {
+                        const SoundProfile& beep = SoundArbiter::profile(SOUND_BEEP);
+                        host::advanceMillis(max(beep.coalesceMs, beep.minDurationMs));
+                        rig.sound.play(SOUND_BEEP);
+                        while (!rig.sound.isIdle()) {
+                            host::advanceMillis(2);
+                            rig.sound.update();
+                        }
+                    }});
+
+    // One op is one GAME_TICK_MS step. Beeps go to the DFPlayer model.
+    list.push_back({"game/defuse/update", 100000, []() { rig.armDefuse(); }, [](unsigned long) {
+                        rig.step();
+                        rig.defuse.tick();
+                        rig.sound.update();
+                    }});
+    list.push_back({"game/defuse/frame", 20000, []() { rig.armDefuse(); }, [](unsigned long) {
+                        rig.step();
+                        rig.defuse.tick();
+                        rig.sound.update();
+                        if (rig.defuse.needsRender()) rig.defuse.render();  // Flushes what changed
+                    }});
+    list.push_back({"game/domination/update", 100000, []() { rig.startDomination(); }, [](unsigned long i) {
+                        rig.step();
+                        rig.teamButtons(i);
+                        rig.domination.tick();
+                    }});
+    list.push_back({"game/domination/frame", 20000, []() { rig.startDomination(); }, [](unsigned long i) {
+                        rig.step();
+                        rig.teamButtons(i);
+                        rig.domination.tick();
+                        if (rig.domination.needsRender()) rig.domination.render();
+                    }});
+    return list;
+}
+
+Result measure(const Benchmark& benchmark, double scale) {
+    using namespace std::chrono;
+    unsigned long iterations = (unsigned long)(benchmark.iterations * scale);
+    if (iterations == 0) iterations = 1;
+    if (benchmark.setup) benchmark.setup();
+
+    // Warm up caches and the shadow framebuffer, untimed
+    for (unsigned long i = 0; i < iterations / 20 + 1; i++) benchmark.op(i);
+
+    unsigned long allocations = allocationCount;
+    unsigned long i2c = Wire.getStats().bytesWritten + Wire.getStats().bytesRead;
+    unsigned long uart = hostBoard().dfPlayer.getBytesReceived();
+    uint64_t bus = host::blockedBusNanos();
+    steady_clock::time_point start = steady_clock::now();
+    for (unsigned long i = 0; i < iterations; i++) benchmark.op(i);
+    double nanos = duration<double, std::nano>(steady_clock::now() - start).count();
+    allocations = allocationCount - allocations;  // Before the result's strings allocate
+
+    Result result;
+    result.name = benchmark.name;
+    result.allocations = allocations;
+    result.nsPerOp = nanos / iterations;
+    result.allocsPerOp = (double)allocations / iterations;
+    result.i2cBytesPerOp = (double)(Wire.getStats().bytesWritten + Wire.getStats().bytesRead - i2c) / iterations;
+    result.uartBytesPerOp = (double)(hostBoard().dfPlayer.getBytesReceived() - uart) / iterations;
+    result.busMicrosPerOp = (host::blockedBusNanos() - bus) / 1000.0 / iterations;
+    return result;
+}
+
+bool loadBaseline(const char* path, std::map<std::string, Result>& baseline) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream words(line);
+        Result result;
+        if (words >> result.name >> result.nsPerOp >> result.allocsPerOp >> result.i2cBytesPerOp >>
+            result.uartBytesPerOp >> result.busMicrosPerOp) {
+            baseline[result.name] = result;
+        }
+    }
+    return true;
+}
+
+bool saveBaseline(const char* path, const std::vector<Result>& results) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "# bench baseline: name ns/op allocs/op i2c_bytes/op uart_bytes/op bus_us/op\n");
+    for (const Result& r : results) {
+        fprintf(file, "%s %.1f %.4f %.2f %.2f %.2f\n", r.name.c_str(), r.nsPerOp, r.allocsPerOp, r.i2cBytesPerOp,
+                r.uartBytesPerOp, r.busMicrosPerOp);
+    }
+    fclose(file);
+    return true;
+}
+
+// Drawing on the ESP8266 must not fragment its small heap: every show*
+// screen and every game frame (update + render) stays off it entirely
+bool mustNotAllocate(const std::string& name) {
+    return name.compare(0, 8, "display/") == 0 || name.find("/frame") != std::string::npos;
+}
+
+// Allocations and bytes come from fixed iteration counts, so any increase
+// is a change in the code, not noise
+bool exceeds(double value, double base) {
+    return value > base + 0.005 + fabs(base) * 0.001;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* savePath = nullptr;
+    const char* baselinePath = nullptr;
+    double scale = 1;
+    double tolerance = 25;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--scale" && i + 1 < argc) scale = atof(argv[++i]);
+        else if (arg == "--save" && i + 1 < argc) savePath = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc) baselinePath = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc) tolerance = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--filter TEXT] [--scale F] [--save FILE] [--baseline FILE] "
+                            "[--tolerance PCT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, Result> baseline;
+    if (baselinePath && !loadBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "cannot read %s\n", baselinePath);
+        return 2;
+    }
+
+    host::setSerialEcho(false);
+    host::setBusTiming(false);
+    rig.init();
+
+    std::vector<Result> results;
+    int regressions = 0;
+    int allocating = 0;  // Ops of mustNotAllocate() that did
+    printf("%-34s %10s %10s %10s %10s %10s\n", "benchmark", "ns/op", "allocs/op", "i2c B/op", "uart B/op",
+           "bus us/op");
+    for (const Benchmark& benchmark : benchmarks()) {
+        if (filter && !strstr(benchmark.name, filter)) continue;
+        Result r = measure(benchmark, scale);
+        results.push_back(r);
+        printf("%-34s %10.1f %10.4f %10.2f %10.2f %10.2f", r.name.c_str(), r.nsPerOp, r.allocsPerOp,
+               r.i2cBytesPerOp, r.uartBytesPerOp, r.busMicrosPerOp);
+
+        if (mustNotAllocate(r.name) && r.allocations != 0) {
+            printf("  ALLOCATES: %lu", r.allocations);
+            allocating++;
+        }
+
+        auto base = baseline.find(r.name);
+        if (base != baseline.end()) {
+            const Result& b = base->second;
+            std::string why;
+            if (r.nsPerOp > b.nsPerOp * (1 + tolerance / 100)) why += " time";
+            if (exceeds(r.allocsPerOp, b.allocsPerOp)) why += " allocs";
+            if (exceeds(r.i2cBytesPerOp, b.i2cBytesPerOp)) why += " i2c";
+            if (exceeds(r.uartBytesPerOp, b.uartBytesPerOp)) why += " uart";
+            if (exceeds(r.busMicrosPerOp, b.busMicrosPerOp)) why += " bus";
+            printf("  %+6.1f%%", (r.nsPerOp / b.nsPerOp - 1) * 100);
+            if (!why.empty()) {
+                printf("  REGRESSED:%s", why.c_str());
+                regressions++;
+            }
+        } else if (baselinePath) {
+            printf("  (new)");
+        }
+        printf("\n");
+    }
+
+    if (savePath && !saveBaseline(savePath, results)) {
+        fprintf(stderr, "cannot write %s\n", savePath);
+        return 2;
+    }
+    if (baselinePath) {
+        printf("%d regression%s against %s\n", regressions, regressions == 1 ? "" : "s", baselinePath);
+    }
+    if (allocating) {
+        printf("%d benchmark%s allocated where none may\n", allocating, allocating == 1 ? "" : "s");
+    }
+    return (regressions || allocating) ? 1 : 0;
+}
@@ -0,0 +1,477 @@
+// Scenario engine, see scenario.h
+
+#include "scenario.h"
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "host_hw.h"
+#include "clock.h"
+#include "game_modes.h"
+#include "display_manager.h"
+#include "sound_manager.h"
+#include "voltage_monitor.h"
+
+namespace {
+
+// "1500", "1500ms", "1.5s", "5m", "5m30s"
+bool parseTime(const std::string& text, unsigned long& ms) {
+    double total = 0;
+    size_t i = 0;
+    if (text.empty()) return false;
+    while (i < text.size()) {
+        size_t used = 0;
+        double value;
+        try {
+            value = std::stod(text.substr(i), &used);
+        } catch (...) {
+            return false;
+        }
+        i += used;
+        std::string unit;
+        while (i < text.size() && isalpha((unsigned char)text[i])) unit += text[i++];
+        if (unit.empty() || unit == "ms") total += value;
+        else if (unit == "s") total += value * 1000;
+        else if (unit == "m") total += value * 60000;
+        else return false;
+    }
+    ms = (unsigned long)(total + 0.5);
+    return true;
+}
+
+bool compare(double actual, const std::string& op, double expected) {
+    if (op == "==") return actual == expected;
+    if (op == "!=") return actual != expected;
+    if (op == "<") return actual < expected;
+    if (op == "<=") return actual <= expected;
+    if (op == ">") return actual > expected;
+    if (op == ">=") return actual >= expected;
+    return false;
+}
+
+const char* ownerName(PointOwnership owner) {
+    switch (owner) {
+        case RED_TEAM: return "red";
+        case GREEN_TEAM: return "green";
+        default: return "neutral";
+    }
+}
+
+const char* dominationStateName(GameState state) {
+    switch (state) {
+        case SETUP: return "setup";
+        case RUNNING: return "running";
+        default: return "game_over";
+    }
+}
+
+const char* defuseStateName(DefuseState state) {
+    switch (state) {
+        case WAITING_TO_ARM: return "waiting";
+        case ARMED: return "armed";
+        case EXPLODED: return "exploded";
+        case DEFUSED: return "defused";
+        default: return "cooldown";
+    }
+}
+
+// ADC count VoltageMonitor turns into this many volts (5 V reference, 1:2 divider)
+int adcForVoltage(double volts) {
+    return (int)(volts / (5.0 * 2) * 1023 + 0.5);
+}
+
+// One simulated bomb: the game, its managers and the inputs main.cpp feeds it
+class ScenarioRun {
+private:
+    const Scenario& scenario;
+    bool checkInvariants;
+    ScenarioResult result;
+
+    ManualClock clock;
+    DisplayManager display;    // Never init()ed: draws into the framebuffer only
+    SoundManager sound;        // Never init()ed: play() is a no-op
+    VoltageMonitor voltage;
+    DefuseMode defuse;
+    DominationMode domination;
+    GameBase* game;
+
+    KeyEventQueue keys;
+    uint16_t nextKeyId = 1;
+    bool redHeld = false;
+    bool greenHeld = false;
+    bool lastRed = false;
+    bool lastGreen = false;
+    unsigned long redSince = 0;
+    unsigned long greenSince = 0;
+
+    // Invariant state
+    int lastRedScore = 0;
+    int lastGreenScore = 0;
+    PointOwnership lastOwner = NEUTRAL;
+    unsigned long matchStart = 0;
+    bool matchStarted = false;
+
+    void fail(int line, const std::string& message);
+    void applyInput(const ScenarioEvent& event);
+    void feedButtons();
+    void evaluate(const ScenarioEvent& event);
+    void checkDomination();
+
+public:
+    ScenarioRun(const Scenario& s, bool invariants);
+    ScenarioResult run();
+};
+
+ScenarioRun::ScenarioRun(const Scenario& s, bool invariants)
+    : scenario(s), checkInvariants(invariants), clock(0) {
+    game = (scenario.mode == DOMINATION_MODE) ? (GameBase*)&domination : (GameBase*)&defuse;
+    game->init();
+    game->setManagers(&display, &sound);
+    game->setClock(&clock);
+
+    if (scenario.defuseSeconds > 0) {
+        defuse.setTimeLimit(scenario.defuseSeconds);
+    }
+    if (scenario.gameMinutes > 0) {
+        // Like the setup screen: down to the minimum, then up in increments
+        int target = scenario.gameMinutes * 60;
+        int before;
+        do {
+            before = domination.getGameTime();
+            domination.setupGameTime(false);
+        } while (domination.getGameTime() != before);
+        while (domination.getGameTime() < target) {
+            before = domination.getGameTime();
+            domination.setupGameTime(true);
+            if (domination.getGameTime() == before) break;
+        }
+        if (domination.getGameTime() != target) {
+            fail(0, "game_time " + std::to_string(scenario.gameMinutes) + " is not selectable");
+        }
+    }
+
+    host::setAnalog(adcForVoltage(4.0));
+    voltage.init();
+}
+
+void ScenarioRun::fail(int line, const std::string& message) {
+    result.passed = false;
+    std::ostringstream text;
+    text << scenario.name;
+    if (line > 0) text << ":" << line;
+    text << " @" << clock.now() << "ms: " << message;
+    result.failures.push_back(text.str());
+}
+
+void ScenarioRun::applyInput(const ScenarioEvent& event) {
+    switch (event.kind) {
+        case ScenarioEvent::KEYS:
+            for (char c : event.target) {
+                KeyEvent key = {c, KEY_PRESS, nextKeyId++, event.atMs};
+                keys.push(key);
+            }
+            game->processKeyEvents(keys);
+            break;
+        case ScenarioEvent::PRESS:
+        case ScenarioEvent::RELEASE: {
+            bool down = event.kind == ScenarioEvent::PRESS;
+            bool& held = (event.target == "red") ? redHeld : greenHeld;
+            unsigned long& since = (event.target == "red") ? redSince : greenSince;
+            if (down && !held) since = event.atMs;
+            held = down;
+            break;
+        }
+        case ScenarioEvent::VOLTAGE:
+            host::setAnalog(adcForVoltage(event.number));
+            break;
+        case ScenarioEvent::EXPECT:
+            break;
+    }
+}
+
+// buttonTask(): edges go to handleButton(), levels to updateButtonStates()
+void ScenarioRun::feedButtons() {
+    if (scenario.mode != DOMINATION_MODE) return;
+    if (redHeld != lastRed) domination.handleButton(redHeld ? 'R' : 'r');
+    if (greenHeld != lastGreen) domination.handleButton(greenHeld ? 'G' : 'g');
+    domination.updateButtonStates(redHeld, greenHeld);
+    lastRed = redHeld;
+    lastGreen = greenHeld;
+}
+
+void ScenarioRun::evaluate(const ScenarioEvent& event) {
+    const std::string& target = event.target;
+    std::string actualText;
+    double actual = 0;
+    bool numeric = true;
+
+    if (target == "state") {
+        numeric = false;
+        actualText = (scenario.mode == DOMINATION_MODE) ? dominationStateName(domination.state)
+                                                        : defuseStateName(defuse.getState());
+    } else if (target == "owner") {
+        numeric = false;
+        actualText = ownerName(domination.getCurrentOwner());
+    } else if (target == "red_score") {
+        actual = domination.getRedScore();
+    } else if (target == "green_score") {
+        actual = domination.getGreenScore();
+    } else if (target == "capture") {
+        actual = domination.getCaptureProgress();
+    } else if (target == "remaining") {
+        actual = (scenario.mode == DOMINATION_MODE) ? domination.getRemainingTime() : defuse.getRemainingTime();
+    } else if (target == "voltage") {
+        actual = voltage.readVoltage();
+    } else {
+        fail(event.line, "unknown expect target '" + target + "'");
+        return;
+    }
+
+    bool ok;
+    if (numeric) {
+        double expected = atof(event.value.c_str());
+        // Voltage goes through the ADC, allow one count of rounding
+        if (target == "voltage" && event.op == "==") ok = fabs(actual - expected) < 0.01;
+        else ok = compare(actual, event.op, expected);
+        if (!ok) {
+            std::ostringstream text;
+            text << "expected " << target << " " << event.op << " " << event.value << ", got " << actual;
+            fail(event.line, text.str());
+        }
+    } else {
+        ok = (event.op == "==") ? actualText == event.value : (event.op == "!=" && actualText != event.value);
+        if (!ok) {
+            fail(event.line, "expected " + target + " " + event.op + " " + event.value + ", got " + actualText);
+        }
+    }
+}
+
+// Rules of the domination game that hold whatever the players do
+void ScenarioRun::checkDomination() {
+    int red = domination.getRedScore();
+    int green = domination.getGreenScore();
+    PointOwnership owner = domination.getCurrentOwner();
+    int capture = domination.getCaptureProgress();
+
+    if (!matchStarted && domination.state != SETUP) {
+        matchStarted = true;
+        matchStart = game->getTickTime();
+    }
+
+    if (capture < 0 || capture > 100) {
+        fail(0, "capture progress out of range: " + std::to_string(capture));
+    }
+    if (red < lastRedScore || green < lastGreenScore) {
+        fail(0, "score went down");
+    }
+    // A pass can run several steps, so a capture and the new owner's first
+    // credit may land in the same pass
+    if (red > lastRedScore && lastOwner != RED_TEAM && owner != RED_TEAM) {
+        fail(0, std::string("red scored while the point was ") + ownerName(lastOwner));
+    }
+    if (green > lastGreenScore && lastOwner != GREEN_TEAM && owner != GREEN_TEAM) {
+        fail(0, std::string("green scored while the point was ") + ownerName(lastOwner));
+    }
+
+    if (matchStarted) {
+        unsigned long played = game->getTickTime() - matchStart;
+        unsigned long matchMs = domination.getGameTime() * 1000;
+        if (played > matchMs) played = matchMs;
+        if ((unsigned long)(red + green) * 1000 > played) {
+            fail(0, "scores " + std::to_string(red) + "+" + std::to_string(green) +
+                    " exceed " + std::to_string(played) + " ms played");
+        }
+        if (domination.state == RUNNING && game->getTickTime() - matchStart > matchMs) {
+            fail(0, "match still running after its time");
+        }
+    }
+
+    // A capture needs DOM_CAPTURE_TIME of continuous holding
+    if (owner != lastOwner && owner != NEUTRAL) {
+        bool held = (owner == RED_TEAM) ? redHeld : greenHeld;
+        unsigned long since = (owner == RED_TEAM) ? redSince : greenSince;
+        if (!held || game->getTickTime() < since + DOM_CAPTURE_TIME) {
+            fail(0, std::string(ownerName(owner)) + " captured after holding " +
+                    std::to_string(held ? game->getTickTime() - since : 0) + " ms");
+        }
+    }
+
+    lastRedScore = red;
+    lastGreenScore = green;
+    lastOwner = owner;
+}
+
+ScenarioResult ScenarioRun::run() {
+    using namespace std::chrono;
+    std::mt19937 jitter(scenario.seed);
+    std::uniform_int_distribution<unsigned long> period(scenario.jitterMin, scenario.jitterMax);
+
+    const std::vector<ScenarioEvent>& events = scenario.events;
+    size_t next = 0;
+    unsigned long now = 0;
+    std::vector<const ScenarioEvent*> due;
+
+    clock.set(now);
+    game->tick(now);
+
+    while (true) {
+        clock.set(now);
+        unsigned long stepsBefore = game->getTickTime();
+
+        bool timed = result.loops % scenario.timeEvery == 0;
+        steady_clock::time_point start;
+        if (timed) start = steady_clock::now();
+        due.clear();
+        while (next < events.size() && events[next].atMs <= now) {
+            if (events[next].kind == ScenarioEvent::EXPECT) due.push_back(&events[next]);
+            else applyInput(events[next]);
+            next++;
+        }
+        feedButtons();
+        game->tick(now);
+        unsigned long steps = (game->getTickTime() - stepsBefore) / GAME_TICK_MS;
+
+        if (timed) {
+            double nanos = duration<double, std::nano>(steady_clock::now() - start).count();
+            result.cpuNanos += nanos;
+            result.timedSteps += steps;
+            if (nanos > result.maxPassNanos) result.maxPassNanos = nanos;
+        }
+        result.loops++;
+        result.steps += steps;
+
+        for (const ScenarioEvent* event : due) {
+            evaluate(*event);
+        }
+        if (checkInvariants && scenario.mode == DOMINATION_MODE) {
+            checkDomination();
+        }
+
+        if (now >= scenario.runUntil) break;
+        unsigned long following = now + period(jitter);
+        if (next < events.size() && events[next].atMs < following) following = events[next].atMs;
+        if (following > scenario.runUntil) following = scenario.runUntil;
+        now = following;
+    }
+
+    result.simulatedMs = now;
+    return result;
+}
+
+} // namespace
+
+void addScenarioEvent(Scenario& scenario, const ScenarioEvent& event) {
+    std::vector<ScenarioEvent>& events = scenario.events;
+    auto position = events.end();
+    while (position != events.begin() && (position - 1)->atMs > event.atMs) --position;
+    events.insert(position, event);
+    if (event.atMs > scenario.runUntil) scenario.runUntil = event.atMs;
+}
+
+bool parseScenarioLine(const std::string& rawLine, int lineNumber, Scenario& scenario, std::string& error) {
+    // '#' is a key too, so only whole lines are comments
+    std::istringstream words(rawLine);
+    std::string word;
+    if (!(words >> word) || word[0] == '#') return true;  // Blank or comment
+
+    if (word == "mode") {
+        std::string mode;
+        words >> mode;
+        if (mode == "defuse") scenario.mode = DEFUSE_MODE;
+        else if (mode == "domination") scenario.mode = DOMINATION_MODE;
+        else { error = "unknown mode '" + mode + "'"; return false; }
+        return true;
+    }
+    if (word == "game_time" || word == "defuse_time" || word == "seed") {
+        long value;
+        if (!(words >> value) || value < 0) {
+            error = word + " needs a number";
+            return false;
+        }
+        if (word == "game_time") scenario.gameMinutes = value;
+        else if (word == "defuse_time") scenario.defuseSeconds = value;
+        else scenario.seed = value;
+        return true;
+    }
+    if (word == "jitter") {
+        if (!(words >> scenario.jitterMin >> scenario.jitterMax) || scenario.jitterMin == 0 ||
+            scenario.jitterMax < scenario.jitterMin) {
+            error = "jitter needs 1 <= min <= max";
+            return false;
+        }
+        return true;
+    }
+    if (word == "run") {
+        std::string time;
+        words >> time;
+        unsigned long until;
+        if (!parseTime(time, until)) { error = "bad time '" + time + "'"; return false; }
+        if (until > scenario.runUntil) scenario.runUntil = until;
+        return true;
+    }
+    if (word != "at") {
+        error = "unknown command '" + word + "'";
+        return false;
+    }
+
+    std::string time, action;
+    words >> time >> action;
+    ScenarioEvent event = {};
+    event.line = lineNumber;
+    if (!parseTime(time, event.atMs)) { error = "bad time '" + time + "'"; return false; }
+
+    if (action == "key") {
+        event.kind = ScenarioEvent::KEYS;
+        words >> event.target;
+    } else if (action == "press" || action == "release") {
+        event.kind = (action == "press") ? ScenarioEvent::PRESS : ScenarioEvent::RELEASE;
+        words >> event.target;
+        if (event.target != "red" && event.target != "green") {
+            error = "press/release needs red or green";
+            return false;
+        }
+    } else if (action == "voltage") {
+        event.kind = ScenarioEvent::VOLTAGE;
+        if (!(words >> event.number)) { error = "voltage needs volts"; return false; }
+    } else if (action == "expect") {
+        event.kind = ScenarioEvent::EXPECT;
+        if (!(words >> event.target >> event.op >> event.value)) {
+            error = "expect needs <target> <op> <value>";
+            return false;
+        }
+    } else {
+        error = "unknown action '" + action + "'";
+        return false;
+    }
+    if (event.kind == ScenarioEvent::KEYS && event.target.empty()) {
+        error = "key needs keys";
+        return false;
+    }
+
+    addScenarioEvent(scenario, event);
+    return true;
+}
+
+bool parseScenario(const char* path, Scenario& scenario, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = std::string(path) + ": cannot open";
+        return false;
+    }
+    scenario.name = path;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!parseScenarioLine(line, lineNumber, scenario, error)) {
+            error = std::string(path) + ":" + std::to_string(lineNumber) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+ScenarioResult runScenario(const Scenario& scenario, bool checkInvariants) {
+    ScenarioRun run(scenario, checkInvariants);
+    return run.run();
+}
@@ -0,0 +1,73 @@
+#ifndef HOST_SCENARIO_H
+#define HOST_SCENARIO_H
+
+// Scenario engine: drives DefuseMode or DominationMode through a timeline of
+// inputs on a ManualClock, the way main.cpp's tasks would, and checks
+// expectations along the way. Scripts are plain text (host/scenarios/*.scn):
+//
+//   mode domination              defuse | domination
+//   game_time 5                  domination match length in minutes
+//   defuse_time 120              defuse countdown in seconds
+//   jitter 2 25                  loop period drawn from [min, max] ms
+//   seed 7                       for the jitter
+//   at 1s key 1234#              key presses, one event per character
+//   at 10s press red             team button held ...
+//   at 12.5s release red         ... and let go
+//   at 30s voltage 3.6           battery voltage seen by VoltageMonitor
+//   at 5m expect red_score >= 200
+//   run 5m2s                     simulate up to this time
+//
+// Lines starting with '#' are comments. Times take ms (default), s or m.
+// Expect targets: state, owner, red_score, green_score, capture, remaining,
+// voltage; operators == != < <= > >=.
+
+#include <string>
+#include <vector>
+#include "config.h"
+
+struct ScenarioEvent {
+    enum Kind { KEYS, PRESS, RELEASE, VOLTAGE, EXPECT };
+
+    unsigned long atMs;
+    Kind kind;
+    std::string target;   // Keys, team, or expect target
+    std::string op;       // Expect operator
+    std::string value;    // Expect value
+    double number;        // Voltage
+    int line;             // Script line, for messages
+};
+
+struct Scenario {
+    std::string name;
+    GameMode mode = DEFUSE_MODE;
+    int defuseSeconds = -1;
+    int gameMinutes = -1;
+    unsigned long jitterMin = 10;
+    unsigned long jitterMax = 10;
+    unsigned long seed = 1;
+    unsigned long runUntil = 0;
+    unsigned long timeEvery = 1;        // Time one pass in N, reading the host clock costs more than a step
+    std::vector<ScenarioEvent> events;  // Kept in time order, ties in script order
+};
+
+struct ScenarioResult {
+    bool passed = true;
+    std::vector<std::string> failures;
+    unsigned long loops = 0;        // Simulated loop passes
+    unsigned long steps = 0;        // Game ticks (GAME_TICK_MS steps) executed
+    double cpuNanos = 0;            // Host time spent inside tick()/input handling, timed passes only
+    unsigned long timedSteps = 0;   // Steps run in the timed passes
+    double maxPassNanos = 0;        // Slowest single pass
+    unsigned long simulatedMs = 0;
+};
+
+bool parseScenario(const char* path, Scenario& scenario, std::string& error);
+bool parseScenarioLine(const std::string& line, int lineNumber, Scenario& scenario, std::string& error);
+void addScenarioEvent(Scenario& scenario, const ScenarioEvent& event);
+
+// checkInvariants: also verify the domination rules on every pass (scores
+// never decrease, only the owner scores, captures take DOM_CAPTURE_TIME of
+// holding, the match ends on time)
+ScenarioResult runScenario(const Scenario& scenario, bool checkInvariants);
+
+#endif // HOST_SCENARIO_H
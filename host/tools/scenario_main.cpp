@@ -0,0 +1,188 @@
+// Scenario runner: plays host/scenarios/*.scn scripts and randomized
+// domination matches faster than real time (see scenario.h).
+//
+//   scenarios [options] [script.scn ...]
+//     --invariants          check the domination rules on every loop pass
+//     --random N            also play N random domination matches (implies
+//                           --invariants for them)
+//     --seed S              first seed of the random matches (default 1)
+//     --dump                print each random match as a script
+//     --max-ns-per-step X   fail if a run averages more host time per game step
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include "scenario.h"
+#include "host_hw.h"
+
+namespace {
+
+struct Totals {
+    unsigned long runs = 0;
+    unsigned long failed = 0;
+    unsigned long steps = 0;
+    unsigned long timedSteps = 0;
+    double cpuNanos = 0;
+    double simulatedMs = 0;
+};
+
+std::string formatTime(unsigned long ms) {
+    char text[32];
+    snprintf(text, sizeof(text), "%lum%05.2fs", ms / 60000, (ms % 60000) / 1000.0);
+    return text;
+}
+
+// A match with random team button traffic. Hold lengths cluster around the
+// capture time, where off-by-one-step mistakes show up, with some long holds.
+Scenario randomMatch(unsigned long seed, std::string& script) {
+    std::mt19937 rng(seed);
+    auto pick = [&rng](long low, long high) {
+        return std::uniform_int_distribution<long>(low, high)(rng);
+    };
+
+    Scenario scenario;
+    std::ostringstream text;
+    scenario.name = "random seed " + std::to_string(seed);
+    scenario.mode = DOMINATION_MODE;
+    scenario.seed = seed;
+    scenario.timeEvery = 16;
+    // Mostly the shortest match: the edge cases are per capture, not per minute
+    scenario.gameMinutes = DOM_MIN_TIME;
+    if (pick(0, 9) == 0) {
+        scenario.gameMinutes += DOM_TIME_INCREMENT * pick(0, (DOM_MAX_TIME - DOM_MIN_TIME) / DOM_TIME_INCREMENT);
+    }
+    scenario.jitterMin = pick(1, 5);
+    scenario.jitterMax = scenario.jitterMin + pick(0, 25);
+    text << "mode domination\ngame_time " << scenario.gameMinutes << "\njitter " << scenario.jitterMin << " "
+         << scenario.jitterMax << "\nseed " << seed << "\n";
+
+    auto add = [&scenario, &text](unsigned long at, ScenarioEvent::Kind kind, const std::string& target,
+                                  const std::string& op = "", const std::string& value = "") {
+        ScenarioEvent event = {};
+        event.atMs = at;
+        event.kind = kind;
+        event.target = target;
+        event.op = op;
+        event.value = value;
+        addScenarioEvent(scenario, event);
+        static const char* const verbs[] = {"key", "press", "release", "voltage", "expect"};
+        text << "at " << at << " " << verbs[kind] << " " << target;
+        if (!op.empty()) text << " " << op << " " << value;
+        text << "\n";
+    };
+
+    unsigned long start = pick(0, 2000);
+    unsigned long end = start + (unsigned long)scenario.gameMinutes * 60000;
+    add(start, ScenarioEvent::KEYS, "#");
+
+    for (const char* team : {"red", "green"}) {
+        unsigned long t = start + pick(1, 5000);
+        while (t < end) {
+            long hold;
+            switch (pick(0, 3)) {
+                case 0: hold = DOM_CAPTURE_TIME + pick(-2 * GAME_TICK_MS, 2 * GAME_TICK_MS); break;
+                case 1: hold = pick(1, 2 * DOM_CAPTURE_TIME); break;
+                case 2: hold = pick(1000, 60000); break;
+                default: hold = pick(1, 200); break;
+            }
+            add(t, ScenarioEvent::PRESS, team);
+            add(t + hold, ScenarioEvent::RELEASE, team);
+            t += hold + pick(1, 20000);
+        }
+    }
+
+    add(end + 1000, ScenarioEvent::EXPECT, "state", "==", "game_over");
+    add(end + 1000, ScenarioEvent::EXPECT, "remaining", "==", "0");
+    script = text.str();
+    return scenario;
+}
+
+bool report(const Scenario& scenario, const ScenarioResult& result, double maxNanosPerStep, bool verbose, Totals& totals) {
+    double perStep = result.timedSteps ? result.cpuNanos / result.timedSteps : 0;
+    bool slow = maxNanosPerStep > 0 && perStep > maxNanosPerStep;
+    bool passed = result.passed && !slow;
+
+    totals.runs++;
+    totals.steps += result.steps;
+    totals.timedSteps += result.timedSteps;
+    totals.cpuNanos += result.cpuNanos;
+    totals.simulatedMs += result.simulatedMs;
+    if (!passed) totals.failed++;
+
+    if (verbose || !passed) {
+        printf("%s %-32s sim %s  %lu passes  %lu steps  %.0f ns/step  max pass %.1f us\n",
+               passed ? "PASS" : "FAIL", scenario.name.c_str(), formatTime(result.simulatedMs).c_str(),
+               result.loops, result.steps, perStep, result.maxPassNanos / 1000);
+    }
+    for (const std::string& failure : result.failures) {
+        printf("  %s\n", failure.c_str());
+    }
+    if (slow) {
+        printf("  %.0f ns/step is over the %.0f ns budget\n", perStep, maxNanosPerStep);
+    }
+    return passed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool invariants = false;
+    bool dump = false;
+    unsigned long randomCount = 0;
+    unsigned long seed = 1;
+    double maxNanosPerStep = 0;
+    std::vector<const char*> scripts;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--invariants") invariants = true;
+        else if (arg == "--dump") dump = true;
+        else if (arg == "--random" && i + 1 < argc) randomCount = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--max-ns-per-step" && i + 1 < argc) maxNanosPerStep = atof(argv[++i]);
+        else if (arg[0] != '-') scripts.push_back(argv[i]);
+        else {
+            fprintf(stderr, "usage: %s [--invariants] [--random N] [--seed S] [--dump] "
+                            "[--max-ns-per-step X] [script.scn ...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    host::setSerialEcho(false);
+    Totals totals;
+
+    for (const char* path : scripts) {
+        Scenario scenario;
+        std::string error;
+        if (!parseScenario(path, scenario, error)) {
+            printf("FAIL %s\n", error.c_str());
+            totals.runs++;
+            totals.failed++;
+            continue;
+        }
+        report(scenario, runScenario(scenario, invariants), maxNanosPerStep, true, totals);
+    }
+
+    if (randomCount > 0) {
+        Totals random;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < randomCount; i++) {
+            std::string script;
+            Scenario scenario = randomMatch(seed + i, script);
+            if (dump) printf("# %s\n%s\n", scenario.name.c_str(), script.c_str());
+            ScenarioResult result = runScenario(scenario, true);
+            if (!report(scenario, result, maxNanosPerStep, false, random)) {
+                printf("  reproduce: --random 1 --seed %lu --dump\n", seed + i);
+            }
+        }
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("random: %lu matches, %lu failed, %.1f simulated hours in %.2f s (%.0f matches/s, %.0f ns/step)\n",
+               random.runs, random.failed, random.simulatedMs / 3600000.0, wall, random.runs / wall,
+               random.timedSteps ? random.cpuNanos / random.timedSteps : 0.0);
+        totals.runs += random.runs;
+        totals.failed += random.failed;
+    }
+
+    printf("%lu run, %lu failed\n", totals.runs, totals.failed);
+    return totals.failed ? 1 : 0;
+}
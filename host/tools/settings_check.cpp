@@ -0,0 +1,222 @@
+// Settings storage check: runs Settings::load()/save() against the emulated
+// EEPROM sector (host/include/EEPROM.h) and checks the record log: the
+// CRC, slot rotation, sequence wrap-around, falling back past a record
+// corrupted in place, erased and legacy flash, and one commit per changed
+// save. Every commit rewrites the whole sector, as on the device, so this
+// says nothing about wear or about power lost during a commit.
+//
+//   settings_check
+//
+// Prints a PASS/FAIL line per case and exits 1 if any case failed.
+
+#include <cstdio>
+#include <cstring>
+#include <EEPROM.h>
+#include "host_hw.h"
+#include "settings.h"
+
+namespace {
+
+int failures = 0;
+
+void check(const char* name, bool ok, const char* detail = "") {
+    printf("%s %s%s%s\n", ok ? "PASS" : "FAIL", name, ok || !*detail ? "" : ": ", ok ? "" : detail);
+    if (!ok) failures++;
+}
+
+const int SLOT_SIZE = sizeof(SettingsRecord);
+
+// Starts a case from new flash, with records or raw bytes written through
+// the EEPROM API so the sector looks like a device would leave it
+void eraseFlash() {
+    EEPROM.eraseFlash();
+    EEPROM.begin(SETTINGS_EEPROM_SIZE);
+    EEPROM.resetStats();
+}
+
+SettingsRecord makeRecord(uint16_t sequence, uint16_t defuseTime) {
+    SettingsRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = SETTINGS_MAGIC;
+    record.version = SETTINGS_VERSION;
+    record.sequence = sequence;
+    record.gameMode = DEFUSE_MODE;
+    record.codeLength = 4;
+    record.defuseTime = defuseTime;
+    record.domTime = 600;
+    memcpy(record.code, "4321", 4);
+    record.crc = Settings::crc16((const uint8_t*)&record, offsetof(SettingsRecord, crc));
+    return record;
+}
+
+void writeRecord(uint8_t slot, const SettingsRecord& record) {
+    EEPROM.begin(SETTINGS_EEPROM_SIZE);
+    EEPROM.put(EEPROM_SETTINGS_START + slot * SLOT_SIZE, record);
+    EEPROM.commit();
+    EEPROM.resetStats();
+}
+
+// Slot whose committed record carries this sequence number, -1 if none
+int slotHolding(uint16_t sequence) {
+    for (int slot = 0; slot < SETTINGS_SLOT_COUNT; slot++) {
+        SettingsRecord record;
+        memcpy(&record, EEPROM.getFlash() + EEPROM_SETTINGS_START + slot * SLOT_SIZE, sizeof(record));
+        if (record.magic == SETTINGS_MAGIC && record.sequence == sequence) return slot;
+    }
+    return -1;
+}
+
+void corruptSlot(uint8_t slot) {
+    int address = EEPROM_SETTINGS_START + slot * SLOT_SIZE + offsetof(SettingsRecord, defuseTime);
+    EEPROM.begin(SETTINGS_EEPROM_SIZE);
+    EEPROM.write(address, EEPROM.read(address) ^ 0x55);
+    EEPROM.commit();
+    EEPROM.resetStats();
+}
+
+bool isDefault(const Settings& settings) {
+    return settings.getGameMode() == DEFUSE_MODE && settings.getDefuseTime() == 300 &&
+           settings.getDomTime() == 600 && strcmp(settings.getCode(), "1234") == 0;
+}
+
+void checkCrc() {
+    // The standard check value of CRC-16/CCITT-FALSE
+    const char* text = "123456789";
+    check("crc16 check value", Settings::crc16((const uint8_t*)text, strlen(text)) == 0x29B1);
+}
+
+void checkErased() {
+    eraseFlash();
+    Settings settings;
+    settings.load();
+    check("erased: defaults", isDefault(settings) && !settings.isStored());
+    check("erased: unchanged save commits nothing",
+          !settings.save() && EEPROM.getStats().commits == 0);
+}
+
+void checkLegacy() {
+    // The old layout: mode, defuse time, domination time, code length and
+    // code as bytes from EEPROM_SETTINGS_START, no header
+    eraseFlash();
+    const uint8_t legacy[] = {1, 0x02, 0x58, 0x03, 0x84, 4, '4', '3', '2', '1'};
+    for (size_t i = 0; i < sizeof(legacy); i++) {
+        EEPROM.write(EEPROM_SETTINGS_START + i, legacy[i]);
+    }
+    EEPROM.commit();
+    Settings settings;
+    settings.load();
+    check("legacy layout: defaults", isDefault(settings) && !settings.isStored());
+}
+
+void checkRotation() {
+    eraseFlash();
+    Settings settings;
+    settings.load();
+    bool rotated = true;
+    for (int i = 0; i < 3 * SETTINGS_SLOT_COUNT; i++) {
+        settings.setDefuseTime(60 + i);
+        settings.save();
+        if (slotHolding(i + 1) != i % SETTINGS_SLOT_COUNT) rotated = false;
+    }
+    check("slot rotation", rotated && settings.getSequence() == 3 * SETTINGS_SLOT_COUNT);
+
+    Settings reloaded;
+    reloaded.load();
+    check("rotation: reload picks the newest",
+          reloaded.getSequence() == 3 * SETTINGS_SLOT_COUNT &&
+          reloaded.getDefuseTime() == 60 + 3 * SETTINGS_SLOT_COUNT - 1);
+
+    // The newest record breaks: the one before it is used
+    int broken = slotHolding(reloaded.getSequence());
+    corruptSlot(broken);
+    Settings fallback;
+    fallback.load();
+    check("corrupt newest: falls back to the previous record",
+          fallback.getSequence() == 3 * SETTINGS_SLOT_COUNT - 1 &&
+          fallback.getDefuseTime() == 60 + 3 * SETTINGS_SLOT_COUNT - 2);
+
+    // Every record breaks: defaults
+    for (int slot = 0; slot < SETTINGS_SLOT_COUNT; slot++) {
+        if (slot != broken) corruptSlot(slot);
+    }
+    Settings none;
+    none.load();
+    check("all records corrupt: defaults", isDefault(none) && !none.isStored());
+}
+
+void checkVersion() {
+    eraseFlash();
+    writeRecord(0, makeRecord(1, 120));
+    SettingsRecord newer = makeRecord(2, 240);
+    newer.version = SETTINGS_VERSION + 1;
+    newer.crc = Settings::crc16((const uint8_t*)&newer, offsetof(SettingsRecord, crc));
+    writeRecord(1, newer);
+    Settings settings;
+    settings.load();
+    check("other version: ignored", settings.getSequence() == 1 && settings.getDefuseTime() == 120);
+}
+
+void checkWrap() {
+    eraseFlash();
+    writeRecord(0, makeRecord(65534, 60));
+    writeRecord(1, makeRecord(65535, 120));
+    writeRecord(2, makeRecord(0, 180));
+    writeRecord(3, makeRecord(1, 240));
+    Settings settings;
+    settings.load();
+    check("sequence wrap: newest after 65535 wins",
+          settings.getSequence() == 1 && settings.getDefuseTime() == 240);
+
+    settings.setDefuseTime(300);
+    settings.save();
+    check("sequence wrap: next save goes to the following slot", slotHolding(2) == 4);
+
+    Settings reloaded;
+    reloaded.load();
+    check("sequence wrap: reload", reloaded.getSequence() == 2 && reloaded.getDefuseTime() == 300);
+}
+
+void checkCommits() {
+    eraseFlash();
+    Settings settings;
+    settings.load();
+    const unsigned long EDITS = 3000;
+    unsigned long redundantCommits = 0;
+    for (unsigned long i = 0; i < EDITS; i++) {
+        settings.setDefuseTime(60 + i % 3000);
+        settings.setCode(i & 1 ? "9876" : "1234");
+        settings.save();
+        unsigned long before = EEPROM.getStats().commits;
+        settings.setDefuseTime(60 + i % 3000);  // Same value again
+        settings.save();
+        redundantCommits += EEPROM.getStats().commits - before;
+    }
+    char detail[64];
+    snprintf(detail, sizeof(detail), "%lu commits", EEPROM.getStats().commits);
+    check("3000 edits: 3000 commits", EEPROM.getStats().commits == EDITS, detail);
+    check("redundant saves: no commits", redundantCommits == 0);
+
+    Settings reloaded;
+    reloaded.load();
+    check("3000 edits: reload", reloaded.getSequence() == EDITS &&
+                                reloaded.getDefuseTime() == (int)(60 + (EDITS - 1) % 3000) &&
+                                strcmp(reloaded.getCode(), "9876") == 0);
+}
+
+}  // namespace
+
+int main() {
+    static_assert(sizeof(SettingsRecord) == 20, "SettingsRecord must not be padded");
+    host::setSerialEcho(false);
+
+    checkCrc();
+    checkErased();
+    checkLegacy();
+    checkRotation();
+    checkVersion();
+    checkWrap();
+    checkCommits();
+
+    printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,39 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <Arduino.h>
+
+// Millisecond time source for the game logic. The firmware uses the real
+// clock; a simulation drives a ManualClock and can replay a whole match
+// exactly, as fast as the host can step it.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual unsigned long now() = 0;
+};
+
+// millis()
+class ArduinoClock : public Clock {
+public:
+    unsigned long now() override { return millis(); }
+};
+
+// Time only moves when told to
+class ManualClock : public Clock {
+private:
+    unsigned long current;
+
+public:
+    explicit ManualClock(unsigned long start = 0) : current(start) {}
+    unsigned long now() override { return current; }
+    void set(unsigned long ms) { current = ms; }
+    void advance(unsigned long ms) { current += ms; }
+};
+
+// Shared real clock, the default for every game
+inline Clock& systemClock() {
+    static ArduinoClock clock;
+    return clock;
+}
+
+#endif // CLOCK_H
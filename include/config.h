@@ -38,11 +38,37 @@
 #define PIN_COL2 5  // P5 on PIN8574
 #define PIN_COL3 6  // P6 on PIN8574
 
+// Keypad scanner timing
+#define KEYPAD_DEBOUNCE_MS 20  // A press/release must be stable this long to count
+#define KEYPAD_SAMPLE_MS (KEYPAD_DEBOUNCE_MS / 4)  // Matrix sample period, 4 samples per debounce
+#define KEYPAD_LONG_PRESS_MS 1000  // Held this long emits a long-press event
+#define KEYPAD_REPEAT_MS 200       // Auto-repeat period after the long press
+
+// Keypad change detection
+// 1: PCF8574 /INT is wired to PIN_KEYPAD_INT, the bus is only scanned after a change
+// 0: scan the expander on every call (boards without the INT wire)
+// D3 is GPIO0, a boot strap: LOW at reset starts the flash loader. /INT is
+// LOW while a change is unread, so a key held while the ESP alone resets
+// (reset button, watchdog; the expander keeps driving the rows) boots it
+// into flash mode. No free pin avoids this on this board: D0 has no
+// interrupt, D4 (GPIO2) is a strap too, the rest are taken.
+// A power-up is safe: the expander starts with every pin pulled up.
+#ifndef KEYPAD_USE_INTERRUPT      // A -D build flag wins
+#define KEYPAD_USE_INTERRUPT 0
+#endif
+#define PIN_KEYPAD_INT D3           // PCF8574 /INT, open drain, active LOW, see the boot strap note
+#define KEYPAD_SAFETY_POLL_MS 500   // Interrupt mode still scans this often, in case an edge is missed
+
 // DFPlayer Mini pins
 // Using software serial with ESP8266
 #define DFPLAYER_RX_PIN D2  // Connect to TX pin on DFPlayer Mini
 #define DFPLAYER_TX_PIN D1  // Connect to RX pin on DFPlayer Mini
 
+// DFPlayer command queue (SoundManager::update() runs from the sound task)
+#define SOUND_QUEUE_SIZE 8          // Pending commands, must be a power of two
+#define SOUND_TX_BYTES_PER_TICK 2   // Frame bytes sent per run, ~1 ms each at 9600 baud
+#define SOUND_COMMAND_GAP_MS 20     // Quiet time the module needs between commands
+
 // Hardware SPI pins for Arduino UNO are fixed:
 // MOSI - Pin 11 (fixed)
 // SCK  - Pin 13 (fixed)
@@ -51,6 +77,8 @@
 // Display settings
 #define SCREEN_WIDTH 128      // OLED display width, in pixels
 #define SCREEN_HEIGHT 64      // OLED display height, in pixels
+#define OLED_I2C_ADDRESS 0x3C // I2C address of the SH1106 panel
+#define SH1106_COLUMN_OFFSET 2 // SH1106 RAM is 132 columns wide, the 128px glass starts at column 2
 
 // Game mode definitions
 enum GameMode {
@@ -67,9 +95,25 @@ enum PointOwnership {
 
 enum DefuseState {
   WAITING_TO_ARM,
-  ARMED
+  ARMED,
+  EXPLODED,   // Timer ran out, result screen showing
+  DEFUSED,    // Correct defuse code, result screen showing
+  COOLDOWN    // Result dismissed, keys ignored until the game resets
 };
 
+// Game logic advances in fixed steps of this many ms, see GameBase::tick()
+#define GAME_TICK_MS 10
+
+// Defuse mode game over timing
+#define DEFUSE_RESULT_MS 5000         // Result screen shown before the game resets
+#define DEFUSE_DISMISS_GUARD_MS 1000  // Keys can't skip the result screen before this
+#define DEFUSE_COOLDOWN_MS 300        // Swallow the dismissing key before resetting
+
+// Defuse mode countdown cues, see cue_timeline.h (beep curve and warnings are tables in cue_timeline.cpp)
+#define CUE_WINDOW_SIZE 8             // Upcoming cues kept ready, must be a power of two
+#define CUE_FLASH_LAST_MS 10000       // Beeps in the last this many ms also flash the screen
+#define CUE_FLASH_MS 150              // How long a flash keeps the screen inverted
+
 // Game state definitions
 enum GameState {
   SETUP,     // Initial setup/configuration
@@ -102,6 +146,7 @@ enum SoundType {
 
 // EEPROM addresses
 #define EEPROM_SETTINGS_START 0   // Start address for settings in EEPROM
+#define SETTINGS_SLOT_COUNT 8     // Settings records rotate through this many slots (one flash sector, no wear leveling)
 
 // Game mode selection switch
 #define PIN_MODE_SWITCH 27  // GPIO pin for game mode selection
@@ -117,4 +162,10 @@ enum SoundType {
 #define DOM_MAX_TIME 60           // Maximum time in minutes
 #define DOM_CAPTURE_TIME 1000     // Time in ms to capture a point (fill slider)
 
+// Diagnostics
+#define PROFILER_ENABLED 0        // 1: time loop stages with the CPU cycle counter ('p' on serial)
+#ifndef LATENCY_TRACE_ENABLED     // A -D build flag wins, see env:native_trace
+#define LATENCY_TRACE_ENABLED 0   // 1: trace key press to beep/pixel latency ('l' on serial)
+#endif
+
 #endif // CONFIG_H
\ No newline at end of file
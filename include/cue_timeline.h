@@ -0,0 +1,64 @@
+#ifndef CUE_TIMELINE_H
+#define CUE_TIMELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// What happens at a cue, several can share one moment
+#define CUE_BEEP 0x01       // Countdown tick, SOUND_TIME
+#define CUE_WARNING 0x02    // Time mark reached, SOUND_WARNING
+#define CUE_FLASH_ON 0x04   // Invert the screen
+#define CUE_FLASH_OFF 0x08  // Back to normal
+
+struct Cue {
+    uint32_t atMs;    // Since the countdown started
+    uint8_t actions;  // CUE_* flags
+};
+
+// Beep interval against the time left: points spaced evenly from nothing
+// left (first) to the full countdown (last), linear in between
+struct CueCurve {
+    const uint16_t* intervalMs;
+    uint8_t points;  // At least 2
+};
+
+// The countdown's beeps, warnings and screen flashes, fixed the moment the
+// bomb is armed. Every cue time derives from the countdown start and the
+// previous cue time, never from when the loop got around to it, so the
+// cadence cannot drift. The schedule is produced in order into a small
+// window that next() refills, which keeps RAM constant for any time limit.
+class CueTimeline {
+private:
+    CueCurve curve;
+    uint32_t durationMs;
+
+    // Generator state: the next cue of each kind, NO_CUE when done
+    static const uint32_t NO_CUE = 0xFFFFFFFF;
+    uint32_t nextBeepMs;
+    uint32_t nextFlashOffMs;
+    uint8_t nextWarning;  // Index into the warning marks
+
+    Cue window[CUE_WINDOW_SIZE];
+    uint8_t head;
+    uint8_t count;
+
+    uint32_t warningAt(uint8_t index) const;
+    bool generate(Cue& cue);
+    void refill();
+
+public:
+    CueTimeline();
+    static const CueCurve& defaultCurve();
+    void setCurve(const CueCurve& beepCurve) { curve = beepCurve; }
+
+    void start(uint32_t duration);  // Schedule for a countdown of this length
+    void clear();
+    uint16_t intervalAt(uint32_t remainingMs) const;  // Beep interval from the curve
+
+    // The earliest cue if it is due at elapsedMs. Call until false: a late
+    // caller gets every cue it missed, in order.
+    bool next(uint32_t elapsedMs, Cue& cue);
+    bool isDone() const { return count == 0; }
+};
+
+#endif // CUE_TIMELINE_H
@@ -6,12 +6,44 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SH110X.h>
 #include "config.h"
+#include "text_layout.h"
 
+#define DISPLAY_PAGES (SCREEN_HEIGHT / 8)  // SH1106 pages are 8 pixel rows each
+#define TEXT_CENTERED -1                   // Pass as x to center text horizontally
+
+// Counters for the incremental flush, so the I2C savings can be checked
+struct DisplayFlushStats {
+    unsigned long flushes;     // Number of update() calls that reached the panel
+    unsigned long pagesSent;   // Pages that had at least one changed column
+    unsigned long bytesSent;   // Framebuffer bytes pushed over I2C
+    unsigned long bytesSaved;  // Framebuffer bytes skipped because the panel already shows them
+};
 
 class DisplayManager {
 private:
     Adafruit_SH1106G display;  // SH1106 I2C driver
     bool initialized;
+    bool inverted;             // Panel showing inverted pixels (0xA7)
+
+    // Shadow copy of what the panel currently shows, used to send only changed columns
+    uint8_t shadow[SCREEN_WIDTH * DISPLAY_PAGES];
+    bool shadowValid;          // False until the panel content is known (forces a full flush)
+    DisplayFlushStats flushStats;
+    unsigned long frameCount;  // update() calls that reached the panel, never reset
+
+    static const uint8_t I2C_CHUNK_SIZE = 31; // Data bytes per transaction (Wire buffer is 32 with the control byte)
+
+    // Panel transfer helpers
+    void flushDirtyPages();
+    void sendPageWindow(uint8_t page, uint8_t column);
+    void sendData(const uint8_t* data, uint8_t length);
+
+    static const uint8_t TIME_TEXT_SIZE = 9;  // "MM:SS" and the terminator, with room to spare
+    static void formatTime(char (&buffer)[TIME_TEXT_SIZE], int timeRemaining);
+
+    // Pre-scaled digit atlas (digit_atlas.h) for the large countdown
+    bool drawAtlasText(const char* text, int16_t x, int16_t y, uint8_t size);
+    void blitGlyph(const uint8_t* glyph, uint8_t width, uint8_t pages, int16_t x, int16_t y);
 
 public:
     DisplayManager();
@@ -20,26 +52,44 @@ public:
     // Basic display functions
     void clear();
     void update();
-    void showCenteredText(const String& text, int y, int size = 1);
+    void invalidate();  // Next update() pushes the whole frame
+    void setInverted(bool on);  // One panel command, the framebuffer is untouched
+    bool isInverted() const { return inverted; }
+    const DisplayFlushStats& getFlushStats() const { return flushStats; }
+    void resetFlushStats();
+    unsigned long getFrameCount() const { return frameCount; }  // Tells a UiScreen its frame was replaced
+    void showCenteredText(const char* text, int y, int size = 1);
+    void showCenteredLabel(const TextLabel& label, int y, int size = 1);
     
     // Game-specific screens
     void showWelcome();
-    void showMenu(const String& title, const String items[], int numItems, int selectedIndex);
+    void showMenu(const char* title, const char* const items[], int numItems, int selectedIndex);
     void showGameMode(GameMode mode);
     void showCountdown(int timeRemaining);
-    void showDefuseScreen(int timeRemaining, bool armed, const String& code = "");
+    void showDefuseScreen(int timeRemaining, bool armed, const char* code = "");
     void showDominationScreen(int redScore, int blueScore, int threshold);
     void showGameOver(bool victory);
-    void showSettings(const String& setting, const String& value);
-    void showPassword(const String& password, bool hidden = true);
+    void showSettings(const char* setting, const char* value);
+    void showPassword(const char* password, bool hidden = true);
     void showBatteryStatus(float voltage);
-    void showError(const String& message);
+    void showError(const char* message);
     
     // Domination mode specific screens
     void showDominationSetup(int minutes);
     void showDominationScreen(int redScore, int greenScore, int captureProgress, 
                               PointOwnership currentOwner, int remainingTime);
     void showDominationGameOver(PointOwnership winner, int redScore, int greenScore);
+
+    // Drawing primitives (framebuffer only, no clear/flush) for retained widgets
+    void drawTimer(int timeRemaining, int16_t x, int16_t y, uint8_t size);
+    void drawDefuseStatus(bool armed);
+    void drawCodeLine(const char* code);
+    void drawGameOver(bool victory);
+    void drawDominationSetup(int minutes);
+    void drawScorePair(int redScore, int greenScore);
+    void drawFlagOwner(PointOwnership currentOwner);
+    void drawCaptureBar(int captureProgress);
+    void drawDominationGameOver(PointOwnership winner, int redScore, int greenScore);
 };
 
 #endif // DISPLAY_MANAGER_H
\ No newline at end of file
@@ -4,6 +4,11 @@
 #include <Arduino.h> // Add this to get millis()
 #include <display_manager.h>
 #include <sound_manager.h>
+#include "ui_widgets.h"
+#include "key_events.h"
+#include "clock.h"
+#include "timekeeping.h"
+#include "cue_timeline.h"
 
 class DisplayManager;
 class SoundManager;
@@ -14,7 +19,10 @@ public:
   GameBase();
   virtual ~GameBase() = default;
   virtual void init() = 0;
-  virtual void update() = 0; // Keep return type as void
+  virtual void update() = 0; // One GAME_TICK_MS step, reads tickTime instead of millis()
+  virtual void render() {}   // Push the model to the display, see needsRender()
+  virtual bool needsRender() { return false; }
+  virtual void showInput() {}  // Push what a key changed into the widgets, in the press's trace context
   virtual void handleInput(int button) = 0;
   virtual bool isGameOver() = 0;
   virtual void reset() = 0;
@@ -22,12 +30,40 @@ public:
   // Add handleButton method to base class
   virtual void handleButton(char button) = 0;
   virtual void setManagers(DisplayManager* d, SoundManager* s) {}
+
+  // Time source for tick(), systemClock() unless replaced
+  void setClock(Clock* source) { clock = source; }
+  Clock& getClock() { return *clock; }
+
+  // Run update() once for every GAME_TICK_MS step up to nowMs. The same
+  // inputs at the same times always give the same game state, however
+  // irregularly tick() itself is called.
+  void tick(unsigned long nowMs);
+  void tick() { tick(clock->now()); }
+  unsigned long getTickTime() const { return tickTime; }
+
+  // Drain every queued keypad event in one batch
+  void processKeyEvents(KeyEventQueue& queue);
+  // Default: presses go to handleButton(), other event types are ignored
+  virtual void handleKeyEvent(const KeyEvent& event);
+
+protected:
+  unsigned long eventTime = 0;  // Timestamp of the key event being handled
+  unsigned long tickTime = 0;   // Game time of the current update() step
+
+  // Now, for inputs sampled between game steps (team buttons). tickTime
+  // would date them back to the last step.
+  unsigned long inputTime() { return clock->now(); }
+
+private:
+  Clock* clock;
+  bool ticking = false;         // tickTime synced to the clock yet
 };
 
 class DefuseMode : public GameBase {
 private:
   DefuseState state;
-  unsigned long startTime;
+  Countdown fuse;  // Runs from the arming key press
   int timeLimit;  // Time limit in seconds
   bool armed;
   int armingCode[4] = {1, 2, 3, 4};
@@ -36,30 +72,53 @@ private:
   int codePosition;
   DisplayManager* display;
   SoundManager* sound;
-  unsigned long lastBeepTime = 0;
+  CueTimeline cues;  // Beeps, warnings and flashes of the armed countdown
+  bool flashOn = false;  // Screen inverted by a CUE_FLASH_ON
+  unsigned long stateTime = 0;  // When EXPLODED/DEFUSED/COOLDOWN was entered
+
+  // Retained defuse screen, redrawn only when one of its widgets changes
+  UiScreen view;
+  UiScreen resultView;
+  StatusBannerWidget statusWidget;
+  TimerWidget timerWidget;
+  CodeLineWidget codeWidget;
+  DefuseResultWidget resultWidget;
+
+  void updateWidgets(int timeRemaining);
+  UiScreen& currentView();
+  void enterState(DefuseState next, unsigned long now);
+  bool updateResult(unsigned long now);
 
 public:
   DefuseMode();
   ~DefuseMode() override = default; 
   void init() override;
   void update() override;
+  void render() override;
+  bool needsRender() override;
+  void showInput() override;
   void handleInput(int button) override;
   bool isGameOver() override;
   void reset() override;
   void setTimeLimit(int seconds);
   void handleButton(char button) override;
   void setManagers(DisplayManager* d, SoundManager* s);
+
+  DefuseState getState() const { return state; }
+  int getRemainingTime() const;  // Seconds on the countdown
 };
 
 
 class DominationMode : public GameBase {
 private:
   unsigned long gameTime;       // Total game time in seconds
-  unsigned long startTime;      // When the game started
-  unsigned long elapsedTime;    // How much time has passed
+  unsigned long defaultGameTime = DOM_DEFAULT_TIME * 60;  // What reset() starts the setup from
+  Countdown matchTimer;         // Runs from the start of the match
+  unsigned long elapsedTime;    // How much time has passed (whole seconds)
   
   PointOwnership currentOwner;  // Who currently owns the point
   unsigned long captureStartTime; // When capturing started
+  bool captureRunning;          // captureStartTime is valid
   int captureProgress;          // 0-100 percent progress
   
   PointOwnership capturingTeam; // Team currently capturing
@@ -69,12 +128,27 @@ private:
 
   int redScore;                 // Red team score (seconds owned)
   int greenScore;               // Green team score (seconds owned)
-  unsigned long lastScoreUpdate; // Last time we updated scores
+  MsAccumulator redHeld;        // Exact time each team owned the point
+  MsAccumulator greenHeld;
+  uint32_t scoredMs;            // Match time already credited to the owner
   
   bool setupComplete;           // Indicates if setup is complete
 
   DisplayManager* display;
   SoundManager* sound;
+
+  // Retained screens for the setup, running and game over states
+  UiScreen setupView;
+  UiScreen runningView;
+  UiScreen resultView;
+  SetupTimeWidget setupWidget;
+  TimerWidget timerWidget;
+  ScorePairWidget scoreWidget;
+  FlagOwnerWidget ownerWidget;
+  CaptureBarWidget captureWidget;
+  DominationResultWidget resultWidget;
+
+  UiScreen& currentView();
 public:
   GameState state;              // Current game state
   
@@ -82,6 +156,8 @@ public:
   ~DominationMode() override = default;
   void init() override;
   void update() override;
+  void render() override;
+  bool needsRender() override;
   void handleInput(int button) override;
   void handleButton(char button) override;
   bool isGameOver() override;
@@ -93,10 +169,12 @@ public:
   void updateCapture();
   void updateScores();
   void setWinThreshold(int seconds);
+  void setDefaultGameTime(unsigned long seconds);  // e.g. the last match length, from Settings
   
   // Getter methods
   unsigned long getGameTime() const { return gameTime; }
   unsigned long getElapsedTime() const { return elapsedTime; }
+  int getRemainingTime() const;  // Seconds left in the match
   int getRedScore() const { return redScore; }
   int getGreenScore() const { return greenScore; }
   int getCaptureProgress() const { return captureProgress; }
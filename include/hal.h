@@ -0,0 +1,25 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+
+// The few ESP8266 specifics the firmware uses beyond the Arduino API. The
+// firmware build maps them onto the ESP core; the host build (HOST_BUILD,
+// see [env:native] in platformio.ini) implements them in host/src/hal_host.cpp
+// next to the in-memory fakes of the Arduino libraries.
+
+#ifdef HOST_BUILD
+
+uint32_t halCycleCount();   // Free-running counter, halCpuMHz() ticks per us
+uint32_t halCpuMHz();
+void halRestart();
+
+#else
+
+inline uint32_t halCycleCount() { return ESP.getCycleCount(); }
+inline uint32_t halCpuMHz() { return ESP.getCpuFreqMHz(); }
+inline void halRestart() { ESP.restart(); }
+
+#endif // HOST_BUILD
+
+#endif // HAL_H
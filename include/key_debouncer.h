@@ -0,0 +1,38 @@
+#ifndef KEY_DEBOUNCER_H
+#define KEY_DEBOUNCER_H
+
+#include <Arduino.h>
+
+#define KEY_DEBOUNCE_SAMPLES 4  // Consecutive differing samples before a key toggles
+
+// Vertical-counter debounce for up to 16 keys at once. Every key has a 2-bit
+// counter, stored bit-sliced across two words (cnt0 holds bit 0 of every
+// counter, cnt1 bit 1), so one update is a handful of bitwise operations no
+// matter how many keys are down. A key toggles after KEY_DEBOUNCE_SAMPLES
+// samples that disagree with its debounced state; any agreeing sample resets
+// its counter.
+class KeyDebouncer {
+private:
+    uint16_t state;  // Debounced state, 1 = pressed
+    uint16_t cnt0;
+    uint16_t cnt1;
+
+public:
+    KeyDebouncer() : state(0), cnt0(0), cnt1(0) {}
+
+    // Feed one raw sample; returns the keys whose debounced state toggled
+    uint16_t update(uint16_t sample) {
+        uint16_t delta = sample ^ state;
+        cnt1 = (cnt1 ^ cnt0) & delta;
+        cnt0 = ~cnt0 & delta;
+        uint16_t toggled = delta & ~(cnt0 | cnt1);
+        state ^= toggled;
+        return toggled;
+    }
+
+    uint16_t getState() const { return state; }
+    bool isSettling() const { return (cnt0 | cnt1) != 0; }  // Some key is mid-count
+    void reset() { state = cnt0 = cnt1 = 0; }
+};
+
+#endif // KEY_DEBOUNCER_H
@@ -0,0 +1,63 @@
+#ifndef KEY_EVENTS_H
+#define KEY_EVENTS_H
+
+#include <Arduino.h>
+
+#define KEY_EVENT_QUEUE_SIZE 16  // Must be a power of two
+
+enum KeyEventType : uint8_t {
+    KEY_PRESS,       // Key went down (debounced)
+    KEY_RELEASE,     // Key went up (debounced)
+    KEY_LONG_PRESS,  // Key held for KEYPAD_LONG_PRESS_MS
+    KEY_REPEAT       // Auto-repeat while still held after a long press
+};
+
+struct KeyEvent {
+    char key;                 // Character from the keypad layout
+    KeyEventType type;
+    uint16_t id;              // Sequence number, follows the event through latency tracing
+    unsigned long timestamp;  // millis() when the edge happened, not when it was read
+};
+
+// Fixed-size single-producer/single-consumer ring buffer. The keypad scanner
+// pushes, the game drains; neither side needs a lock because each index is
+// only ever written by one side.
+class KeyEventQueue {
+private:
+    KeyEvent events[KEY_EVENT_QUEUE_SIZE];
+    volatile uint8_t head;  // Next slot to write (producer)
+    volatile uint8_t tail;  // Next slot to read (consumer)
+    unsigned long dropped;  // Events lost because the queue was full
+
+public:
+    KeyEventQueue() : head(0), tail(0), dropped(0) {}
+
+    bool push(const KeyEvent& event) {
+        uint8_t next = (head + 1) & (KEY_EVENT_QUEUE_SIZE - 1);
+        if (next == tail) {
+            dropped++;
+            return false;
+        }
+        events[head] = event;
+        head = next;
+        return true;
+    }
+
+    bool pop(KeyEvent& event) {
+        if (tail == head) return false;
+        event = events[tail];
+        tail = (tail + 1) & (KEY_EVENT_QUEUE_SIZE - 1);
+        return true;
+    }
+
+    // Look at the i-th pending event without consuming it
+    const KeyEvent& peek(uint8_t index) const {
+        return events[(tail + index) & (KEY_EVENT_QUEUE_SIZE - 1)];
+    }
+
+    uint8_t count() const { return (head - tail) & (KEY_EVENT_QUEUE_SIZE - 1); }
+    bool isEmpty() const { return head == tail; }
+    unsigned long getDropped() const { return dropped; }
+};
+
+#endif // KEY_EVENTS_H
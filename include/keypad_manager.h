@@ -4,7 +4,17 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "config.h"
+#include "key_events.h"
+#include "key_debouncer.h"
 
+// Whole-port patterns for the row/column inversion scan. PCF8574 pins are
+// quasi-bidirectional: writing 1 leaves a weak pull-up (input), 0 drives LOW.
+#define KEYPAD_ROW_MASK ((1 << PIN_ROW1) | (1 << PIN_ROW2) | (1 << PIN_ROW3) | (1 << PIN_ROW4))
+#define KEYPAD_COL_MASK ((1 << PIN_COL1) | (1 << PIN_COL2) | (1 << PIN_COL3))
+#define KEYPAD_DRIVE_ROWS ((uint8_t)~KEYPAD_ROW_MASK)  // Rows LOW, read columns
+#define KEYPAD_DRIVE_COLS ((uint8_t)~KEYPAD_COL_MASK)  // Columns LOW, read rows
+
+#define KEYPAD_KEYS 12  // Key bit r * 3 + c in the sample masks
 
 class KeypadManager {
 private:
@@ -25,18 +35,62 @@ private:
     
     char lastKey = 0;         // Variable to store the last key pressed
 
-    // I2C helper methods
+    // Non-blocking scanner state: all 12 keys are debounced together, one
+    // bit per key, from samples taken every KEYPAD_SAMPLE_MS
+    KeyDebouncer debouncer;
+    uint16_t edgePending = 0;                // Keys whose raw state differs from the debounced one
+    unsigned long rawEdge[KEYPAD_KEYS] = {}; // When each of them first left the debounced state
+
+    // Long-press/auto-repeat follows the most recently pressed key
+    int8_t repeatKey = -1;        // Key bit, -1 = none held
+    unsigned long nextRepeat = 0; // Due time of the next long-press/repeat event
+    bool longPressSent = false;
+
+    KeyEventQueue events;         // Timestamped press/release/long-press/repeat events
+    uint16_t nextEventId = 1;
+    void pushEvent(char key, KeyEventType type, unsigned long timestamp);
+    char applySample(uint16_t sample, unsigned long now);
+    void updateHeldKey(unsigned long now);
+    char keyForBit(uint8_t bit) const { return keypadLayout[bit / 3][bit % 3]; }
+
+    // Time and bus traffic spent inside scanKeypad(), to check it stays bounded
+    unsigned long lastScanMicros = 0;
+    unsigned long maxScanMicros = 0;
+    uint8_t scanTransactions = 0;       // I2C transactions of the scan in progress
+    uint8_t lastScanTransactions = 0;
+    unsigned long totalScans = 0;
+    unsigned long totalTransactions = 0;
+    unsigned long skippedScans = 0;     // Calls that did not touch the bus
+
+    // Interrupt mode: set from the PCF8574 /INT ISR when any pin changed
+    static volatile bool changePending;
+    unsigned long lastBusScan = 0;
+    static void onExpanderInterrupt();
+    bool needsBusScan(unsigned long now) const;
+    uint8_t idleColumns = 0;            // Columns LOW in the idle pattern, at the last sample
+    void rearmInterrupt();
+
+    uint16_t sampleMatrix();
+    uint16_t scanRows(uint8_t rowBits);
+
+    // Whole-port I2C helpers
     void writePort(uint8_t value);
+    void drivePort(uint8_t value);  // writePort() only if the pins change
     uint8_t readPort();
-    void pinMode_I2C(uint8_t pin, uint8_t mode);
-    void digitalWrite_I2C(uint8_t pin, uint8_t value);
-    uint8_t digitalRead_I2C(uint8_t pin);
 
 public:
     KeypadManager(uint8_t address = PCF8574_ADDRESS);
     void init();
     char scanKeypad();
     char getLastKey() { return lastKey; }
+    KeyEventQueue& getEvents() { return events; }
+    unsigned long getLastScanMicros() const { return lastScanMicros; }
+    unsigned long getMaxScanMicros() const { return maxScanMicros; }
+    uint8_t getLastScanTransactions() const { return lastScanTransactions; }
+    unsigned long getTotalScans() const { return totalScans; }
+    unsigned long getTotalTransactions() const { return totalTransactions; }
+    unsigned long getSkippedScans() const { return skippedScans; }
+    void resetScanStats();
 };
 
 #endif // KEYPAD_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef LATENCY_TRACER_H
+#define LATENCY_TRACER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "key_events.h"
+
+#define LATENCY_MAX_OPEN 8        // Presses traced at the same time
+#define LATENCY_SAMPLES 64        // Completed latencies kept per milestone
+#define LATENCY_TIMEOUT_MS 2000   // Give up on a press whose beep/pixels never came
+
+// Milestones a key press passes on its way to the player
+enum LatencyMilestone : uint8_t {
+    LATENCY_HANDLED,  // GameBase::processKeyEvents() handed it to the game
+    LATENCY_BEEP,     // SoundManager finished sending the feedback sound
+    LATENCY_PIXEL,    // First display flush that showed pixels the press changed
+    LATENCY_MILESTONES
+};
+
+#if LATENCY_TRACE_ENABLED
+
+// End-to-end input latency tracing. Every KEY_PRESS is tagged with its id and
+// edge timestamp when the keypad queues it; milestones are stamped with
+// millis() as the press moves through the firmware. Sounds, and widgets that
+// change, are attributed to the press whose handling is in progress (see
+// setContext()); a flush only counts for the presses whose widgets it drew.
+class LatencyTracer {
+private:
+    struct Trace {
+        uint16_t id;                                  // 0 = slot free
+        unsigned long pressTime;                      // Key edge (KeyEvent::timestamp)
+        unsigned long milestone[LATENCY_MILESTONES];  // millis() when reached
+        uint8_t reached;                              // Bit per LatencyMilestone
+        bool drawn;                                   // Its pixels are in the next flush
+    };
+
+    struct SampleRing {
+        uint16_t values[LATENCY_SAMPLES];  // Latency in ms
+        uint8_t next;
+        uint8_t count;
+    };
+
+    static Trace open[LATENCY_MAX_OPEN];
+    static SampleRing samples[LATENCY_MILESTONES];
+    static uint16_t context;                 // Press whose consequences are running
+    static unsigned long timedOut;
+
+    static Trace* find(uint16_t id);
+    static void mark(Trace& trace, LatencyMilestone milestone, unsigned long now);
+    static void retireIfDone(Trace& trace, unsigned long now);
+    static uint16_t percentile(const SampleRing& ring, uint8_t percent);
+
+public:
+    static void captured(const KeyEvent& event);
+    static void setContext(uint16_t id) { context = id; }
+    static void clearContext() { context = 0; }
+    static void handled(uint16_t id);
+    static void soundSent(uint16_t id);      // id 0 = current context
+    static void pixelsDrawn(uint16_t id);    // id 0 = current context
+    static void pixelsFlushed();
+    static void reset();
+    
+    // P50/P99 of press -> milestone in ms, 0 when no samples yet
+    static uint16_t getPercentile(LatencyMilestone milestone, uint8_t percent);
+    static uint8_t getSampleCount(LatencyMilestone milestone) { return samples[milestone].count; }
+    static uint16_t getContext() { return context; }
+    static void printReport(Print& out);
+};
+
+#define TRACE_KEY_CAPTURED(event) LatencyTracer::captured(event)
+#define TRACE_KEY_HANDLED(id) LatencyTracer::handled(id)
+#define TRACE_CONTEXT(id) LatencyTracer::setContext(id)
+#define TRACE_CONTEXT_END() LatencyTracer::clearContext()
+#define TRACE_SOUND_SENT(id) LatencyTracer::soundSent(id)
+#define TRACE_PIXELS_DRAWN(id) LatencyTracer::pixelsDrawn(id)
+#define TRACE_PIXELS_FLUSHED() LatencyTracer::pixelsFlushed()
+#define TRACE_CURRENT_CONTEXT() LatencyTracer::getContext()
+
+#else
+
+// Tracing disabled: hooks compile to nothing
+#define TRACE_KEY_CAPTURED(event) ((void)0)
+#define TRACE_KEY_HANDLED(id) ((void)0)
+#define TRACE_CONTEXT(id) ((void)0)
+#define TRACE_CONTEXT_END() ((void)0)
+#define TRACE_SOUND_SENT(id) ((void)0)
+#define TRACE_PIXELS_DRAWN(id) ((void)0)
+#define TRACE_PIXELS_FLUSHED() ((void)0)
+#define TRACE_CURRENT_CONTEXT() ((uint16_t)0)
+
+#endif // LATENCY_TRACE_ENABLED
+
+#endif // LATENCY_TRACER_H
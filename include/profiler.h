@@ -0,0 +1,69 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "hal.h"
+
+// Loop stages and manager calls that can be timed
+enum ProfileProbe : uint8_t {
+    PROBE_SCHEDULER_PASS,  // All tasks run by one Scheduler::run(), sleep excluded
+    PROBE_KEYPAD_SCAN,
+    PROBE_BUTTONS,
+    PROBE_GAME_UPDATE,
+    PROBE_RENDER,
+    PROBE_DISPLAY_FLUSH,
+    PROBE_SOUND_PLAY,
+    PROBE_SOUND_TX,        // Frame bytes written by the sound task
+    PROBE_VOLTAGE,
+    PROBE_COUNT
+};
+
+#define PROFILER_BUCKETS 16        // Log2 histogram buckets per probe
+#define PROFILER_FIRST_BUCKET_LOG2 7  // Bucket 0 holds everything below 2^8 cycles (~3 us at 80 MHz)
+
+#if PROFILER_ENABLED
+
+// Per-probe statistics, all in static memory
+struct ProbeStats {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint16_t histogram[PROFILER_BUCKETS];  // Bucket i >= 1: [2^(i+7), 2^(i+8)) cycles
+};
+
+class Profiler {
+private:
+    static ProbeStats probes[PROBE_COUNT];
+
+public:
+    static void record(ProfileProbe probe, uint32_t cycles);
+    static void reset();
+    static void printReport(Print& out);
+    static const ProbeStats& getStats(ProfileProbe probe) { return probes[probe]; }
+};
+
+// Times the enclosing scope with the CPU cycle counter
+class ProfileScope {
+private:
+    ProfileProbe probe;
+    uint32_t start;
+
+public:
+    explicit ProfileScope(ProfileProbe p) : probe(p), start(halCycleCount()) {}
+    ~ProfileScope() { Profiler::record(probe, halCycleCount() - start); }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(probe) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(probe)
+
+#else
+
+// Profiling disabled: probes compile to nothing
+#define PROFILE_SCOPE(probe) ((void)0)
+
+#endif // PROFILER_ENABLED
+
+#endif // PROFILER_H
@@ -0,0 +1,53 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 8
+
+typedef void (*TaskFunction)();
+
+// One periodic (or on-demand) job with its run-time accounting
+struct ScheduledTask {
+    const char* name;
+    TaskFunction function;
+    unsigned long period;        // ms between runs, 0 = only when requested
+    unsigned long nextRun;       // millis() deadline of the next run
+    unsigned long budgetMicros;  // Expected worst-case slice
+    bool requested;              // Run on the next pass regardless of the deadline
+
+    unsigned long runs;
+    unsigned long totalMicros;
+    unsigned long maxMicros;
+    unsigned long overruns;      // Runs longer than budgetMicros
+    unsigned long missed;        // Deadlines skipped because the task ran late
+};
+
+// Cooperative scheduler: every task runs to completion, tasks are expected
+// to do a bounded amount of work per call. run() executes whatever is due
+// and then sleeps (delay() yields to the ESP8266 system tasks) until the
+// nearest deadline instead of pacing the firmware with a fixed delay.
+class Scheduler {
+private:
+    ScheduledTask tasks[SCHEDULER_MAX_TASKS];
+    uint8_t taskCount;
+    unsigned long idleMillis;    // Time spent sleeping between deadlines
+
+    void runTask(ScheduledTask& task, unsigned long now);
+    unsigned long millisUntilNextRun(unsigned long now) const;
+
+public:
+    Scheduler();
+    // Returns the task id, or -1 when the table is full
+    int8_t addTask(const char* name, TaskFunction function, unsigned long periodMs, unsigned long budgetMicros);
+    void request(int8_t id);     // Run an on-demand task on the next pass
+    void run();
+    
+    uint8_t getTaskCount() const { return taskCount; }
+    const ScheduledTask& getTask(uint8_t id) const { return tasks[id]; }
+    unsigned long getIdleMillis() const { return idleMillis; }
+    void resetStats();
+    void printStats(Print& out) const;
+};
+
+#endif // SCHEDULER_H
@@ -5,27 +5,59 @@
 #include "config.h"
 #include <EEPROM.h>
 
+#define SETTINGS_MAGIC 0xA5
+#define SETTINGS_VERSION 1
+
+// One saved copy of the settings, as laid out in EEPROM. Fields are ordered
+// so the struct has no padding.
+struct SettingsRecord {
+    uint8_t magic;        // SETTINGS_MAGIC, tells a record from erased or old data
+    uint8_t version;      // SETTINGS_VERSION of the layout
+    uint16_t sequence;    // +1 per save, the highest valid one is current
+    uint8_t gameMode;
+    uint8_t codeLength;
+    uint16_t defuseTime;
+    uint16_t domTime;
+    char code[8];
+    uint16_t crc;         // CRC-16/CCITT of everything above
+};
+
+#define SETTINGS_EEPROM_SIZE (EEPROM_SETTINGS_START + SETTINGS_SLOT_COUNT * sizeof(SettingsRecord))
+
+// Settings persisted as a log of records. save() writes a full record to
+// the slot after the current one and commits once, and only when a field
+// actually changed. load() keeps the newest record that passes its checks,
+// so a record whose bytes came back wrong falls back to the one before it.
+// All slots share the one flash sector that EEPROM.commit() erases and
+// rewrites, so rotating does not spread wear, and power lost during a
+// commit can lose every record (load() then uses the defaults).
 class Settings {
 private:
     byte gameMode;        // 0: Defuse, 1: Domination
     int defuseTime;       // Time in seconds for defuse mode
-    int domTime;          // Score threshold for domination mode
+    int domTime;          // Last domination match length in seconds
     byte codeLength;      // Length of code for defuse mode
     char code[8];         // Code for defuse mode (max 7 chars + null terminator)
+
+    bool opened;          // EEPROM.begin() done
+    bool dirty;           // A field changed since the last load/save
+    int8_t currentSlot;   // Slot of the record in use, -1 = none valid
+    uint16_t sequence;    // Its sequence number
     
     // Default values - Don't use macros to avoid conflict
     static const int DEFAULT_DEFUSE_TIME_MINUTES = 5; // minutes
     static const int DEFAULT_DOM_TIME_MINUTES = 10;   // minutes
     static const byte DEFAULT_CODE_LENGTH = 4;
     
-    // EEPROM read/write helpers
-    void writeInt(int addr, int value);
-    int readInt(int addr);
+    void open();
+    static int slotAddress(uint8_t slot);
+    static bool isValid(const SettingsRecord& record);
+    void apply(const SettingsRecord& record);
     
 public:
     Settings();
     void load();
-    void save();
+    bool save();   // false if nothing changed or the commit failed
     void reset();
     
     // Getters
@@ -34,6 +66,9 @@ public:
     int getDomTime() const { return domTime; }
     byte getCodeLength() const { return codeLength; }
     const char* getCode() const { return code; }
+    bool isDirty() const { return dirty; }
+    uint16_t getSequence() const { return sequence; }
+    bool isStored() const { return currentSlot >= 0; }  // load() found a valid record
     
     // Setters
     void setGameMode(byte mode);
@@ -41,6 +76,9 @@ public:
     void setDomTime(int score);
     void setCodeLength(byte length);
     void setCode(const char* newCode);
+
+    // CRC-16/CCITT of a record, also used by the host check to craft records
+    static uint16_t crc16(const uint8_t* data, size_t length);
 };
 
-#endif // SETTINGS_H
\ No newline at end of file
+#endif // SETTINGS_H
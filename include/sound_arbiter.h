@@ -0,0 +1,70 @@
+#ifndef SOUND_ARBITER_H
+#define SOUND_ARBITER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define SOUND_DEFER_MAX_MS 3000  // Deferred cues older than this are dropped; covers the longest minDurationMs
+#define SOUND_HOLD_MAX_MS 10000  // A holdToEnd cue whose end is never reported is released after this
+
+// How a SoundType competes for the single DFPlayer channel
+struct SoundProfile {
+    uint8_t priority;        // Higher cuts off lower
+    uint16_t minDurationMs;  // Protected from equal/lower priority for this long
+    uint16_t coalesceMs;     // Repeats of the same sound inside this window are merged
+    bool deferrable;         // Held back (instead of dropped) while a higher cue plays
+    bool holdToEnd;          // Protected until the module reports the track over, see SOUND_HOLD_MAX_MS
+};
+
+// Counters to tune the profiles from logs ('a' on the console)
+struct SoundArbiterStats {
+    unsigned long played;     // Requests that went to the player
+    unsigned long coalesced;  // Repeats merged into the one already playing
+    unsigned long dropped;    // Lost to a cue of higher or equal priority
+    unsigned long deferred;   // Held back, see SOUND_DEFER_MAX_MS
+    unsigned long preempted;  // Cues cut off inside their minimum duration
+    unsigned long expired;    // Deferred cues that waited too long
+};
+
+// Decides which requested sound reaches the DFPlayer, which can only play
+// one track at a time. SoundManager asks it before queueing a play command.
+class SoundArbiter {
+private:
+    uint8_t current;                // Sound playing, 0 = none
+    unsigned long currentStart;
+    uint8_t pending;                // Deferred sound, 0 = none
+    unsigned long pendingSince;
+    unsigned long lastStart[SOUND_WARNING + 1];  // Per sound, for coalescing
+    uint16_t startedMask;           // Sounds with a valid lastStart
+    SoundArbiterStats stats;
+
+    // State before the last start(), for notStarted()
+    struct {
+        uint8_t sound;
+        uint8_t current;
+        unsigned long currentStart;
+        unsigned long lastStart;
+        uint16_t startedMask;
+        bool preempted;
+    } undo;
+
+    bool protects(unsigned long now) const;  // Current cue inside its minimum duration, or held to its end
+    void start(uint8_t sound, unsigned long now);
+
+public:
+    SoundArbiter();
+    static const SoundProfile& profile(uint8_t sound);
+
+    bool request(uint8_t sound, unsigned long now);  // true = play it now
+    uint8_t poll(unsigned long now);  // A deferred sound that may play now, 0 = none
+    void stopped();                   // The player was told to stop
+    void trackEnded(uint16_t track);  // The module reported this track over, a deferred cue may go
+    void notStarted();                // The sound just allowed never reached the player, forget it
+
+    uint8_t getCurrent() const { return current; }
+    const SoundArbiterStats& getStats() const { return stats; }
+    void resetStats();
+    void printStats(Print& out) const;
+};
+
+#endif // SOUND_ARBITER_H
@@ -5,6 +5,7 @@
 #include "config.h"
 #include <DFRobotDFPlayerMini.h>
 #include <SoftwareSerial.h>
+#include "sound_arbiter.h"
 
 #define planted_sound '00.wav';
 #define defused_sound '01.wav';
@@ -15,22 +16,84 @@
 
 // Sound effect definitions are already in config.h
 
+#define DFPLAYER_FRAME_SIZE 10  // 7E FF 06 cmd ack paramH paramL sumH sumL EF
+
+// DFPlayer command waiting in the queue
+struct SoundCommand {
+    uint8_t command;
+    uint16_t parameter;
+    uint16_t traceId;  // Key press it answers, for latency tracing
+};
+
+// Called from update() when the module reports the end of a track
+typedef void (*TrackFinishedHandler)(uint16_t track);
+
 class SoundManager {
 private:
     SoftwareSerial dfPlayerSerial;
-    DFRobotDFPlayerMini dfPlayer;
+    DFRobotDFPlayerMini dfPlayer;  // Only for the power-on handshake in init()
     bool initialized;
     uint8_t volume;
+    uint8_t moduleVolume;         // Last volume queued for the module, 0xFF = unknown
+
+    // Commands are queued and sent by update(), a few bytes per call, so
+    // play() never waits for the 9600 baud line
+    SoundCommand queue[SOUND_QUEUE_SIZE];
+    uint8_t queueHead;            // Next slot to write
+    uint8_t queueTail;            // Next slot to send
+    unsigned long dropped;        // Commands lost because the queue was full
+    uint8_t frame[DFPLAYER_FRAME_SIZE];  // Frame being sent
+    uint8_t framePosition;        // Bytes of it already written, DFPLAYER_FRAME_SIZE = idle
+    uint16_t frameTraceId;
+    unsigned long lastFrameTime;  // When the last frame was completed
+
+    SoundArbiter arbiter;         // Which of the requested sounds get played
+
+    // What the module reports on its own, parsed by update() as it arrives.
+    // Nothing is ever asked of it, so none of this costs a round trip.
+    uint8_t rxFrame[DFPLAYER_FRAME_SIZE];
+    uint8_t rxPosition;
+    bool playing;                 // A play was sent and its track has not ended
+    uint16_t playingTrack;
+    unsigned long tracksFinished;
+    uint16_t lastFinishedTrack;
+    unsigned long moduleErrors;
+    uint8_t lastError;            // DFPlayer error code (0x40 reply), 0 = none
+    unsigned long rxBadFrames;
+    TrackFinishedHandler onTrackFinished;
+
+    bool enqueue(uint8_t command, uint16_t parameter);
+    void queueVolume(uint8_t vol);
+    bool startTrack(uint8_t sound);
+    void startFrame(const SoundCommand& command);
+    void frameSent();
+    void receive(uint8_t c);
+    void handleReply(uint8_t command, uint16_t parameter);
+    void trackEnded(uint16_t track);
 
 public:
     SoundManager();
     bool init();
+    void update();  // Sound task: drain the queue and read module replies, see SOUND_TX_BYTES_PER_TICK
     void play(uint8_t sound);
     void playWithVolume(uint8_t sound, uint8_t volume);
     void setVolume(uint8_t volume);
     uint8_t getVolume();
     void playBeepAd(uint8_t track);
     void stop();
+
+    uint8_t getPendingCommands() const { return (queueHead - queueTail) & (SOUND_QUEUE_SIZE - 1); }
+    bool isIdle() const { return queueHead == queueTail && framePosition == DFPLAYER_FRAME_SIZE; }
+    unsigned long getDropped() const { return dropped; }
+    SoundArbiter& getArbiter() { return arbiter; }
+
+    bool isPlaying() const { return playing; }
+    unsigned long getTracksFinished() const { return tracksFinished; }
+    uint16_t getLastFinishedTrack() const { return lastFinishedTrack; }
+    uint8_t getLastError() const { return lastError; }
+    void setTrackFinishedHandler(TrackFinishedHandler handler) { onTrackFinished = handler; }
+    void resetStats();
+    void printStats(Print& out) const;
 };
 
 #endif // SOUND_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef TEXT_FORMAT_H
+#define TEXT_FORMAT_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// Allocation-free text formatting for the render path. Everything is written
+// into fixed-size stack or static buffers; Arduino String is not used because
+// every concatenation hits the heap and fragments the ESP-01's ~40 KB.
+
+// snprintf into buffer, always null-terminated, output truncated to fit.
+// The format string is checked against the arguments by the compiler.
+// Returns the number of characters actually stored.
+inline int formatText(char* buffer, size_t size, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+inline int formatText(char* buffer, size_t size, const char* format, ...) {
+    if (size == 0) return 0;
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer, size, format, args);
+    va_end(args);
+    if (written < 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return (written < (int)size) ? written : (int)size - 1;
+}
+
+// Capacity of a char array, fails to compile when given a pointer
+template <size_t N>
+constexpr size_t textCapacity(char (&)[N]) { return N; }
+
+// Format into a char array whose size is taken from its type:
+//   char line[16];
+//   FORMAT_TEXT(line, "R:%d  B:%d", red, blue);
+#define FORMAT_TEXT(buffer, ...) formatText(buffer, textCapacity(buffer), __VA_ARGS__)
+
+#endif // TEXT_FORMAT_H
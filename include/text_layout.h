@@ -0,0 +1,37 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Text layout for the built-in Adafruit_GFX 5x7 font. The font is fixed
+// width, so a string's width is simply length * 6 * size and there is no
+// need to walk every glyph through getTextBounds() to center it.
+
+#define FONT_GLYPH_WIDTH 6   // 5 pixel glyph + 1 pixel spacing
+#define FONT_GLYPH_HEIGHT 8  // 7 pixel glyph + 1 pixel spacing
+
+constexpr int16_t textWidth(size_t length, uint8_t size) {
+    return (int16_t)(length * FONT_GLYPH_WIDTH * size);
+}
+
+// Left edge that centers the text on the panel; text wider than the panel
+// starts at 0 and wraps like print() does
+constexpr int16_t centeredTextX(size_t length, uint8_t size) {
+    return (textWidth(length, size) >= SCREEN_WIDTH) ? 0 : (SCREEN_WIDTH - textWidth(length, size)) / 2;
+}
+
+// A string literal with its length taken at compile time, so laying out a
+// static label ("ARMED", "MISSION", ...) costs no strlen and no glyph walk
+struct TextLabel {
+    const char* text;
+    uint8_t length;
+
+    template <size_t N>
+    constexpr TextLabel(const char (&literal)[N]) : text(literal), length(N - 1) {}
+
+    constexpr int16_t width(uint8_t size) const { return textWidth(length, size); }
+    constexpr int16_t centeredX(uint8_t size) const { return centeredTextX(length, size); }
+};
+
+#endif // TEXT_LAYOUT_H
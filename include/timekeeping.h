@@ -0,0 +1,79 @@
+#ifndef TIMEKEEPING_H
+#define TIMEKEEPING_H
+
+#include <Arduino.h>
+
+// Millisecond bookkeeping shared by the game modes. Everything works on
+// differences of unsigned timestamps, so it keeps counting correctly across
+// the millis() wrap after 49.7 days.
+
+// later - earlier as a signed value; negative when "later" is actually earlier
+inline long timeDiff(unsigned long later, unsigned long earlier) {
+    return (long)(later - earlier);
+}
+
+// Time since a moment, 0 if that moment is still ahead (e.g. a key edge
+// stamped slightly after the last game step)
+inline unsigned long elapsedMs(unsigned long now, unsigned long since) {
+    long diff = timeDiff(now, since);
+    return (diff > 0) ? (unsigned long)diff : 0;
+}
+
+inline bool timeReached(unsigned long now, unsigned long deadline) {
+    return timeDiff(now, deadline) >= 0;
+}
+
+// Sums irregular time slices exactly. Whole seconds are derived from the
+// total, so the sub-second rest of every slice carries into the next one
+// instead of being dropped.
+class MsAccumulator {
+private:
+    uint32_t totalMs;
+
+public:
+    MsAccumulator() : totalMs(0) {}
+    void add(uint32_t ms) { totalMs += ms; }
+    void reset() { totalMs = 0; }
+    uint32_t getMs() const { return totalMs; }
+    uint32_t getSeconds() const { return totalMs / 1000; }
+};
+
+// Fixed-length countdown anchored at its start time. Remaining time is
+// always computed from the anchor, never decremented, so it cannot drift.
+class Countdown {
+private:
+    unsigned long startMs;
+    uint32_t durationMs;
+
+public:
+    Countdown() : startMs(0), durationMs(0) {}
+
+    void start(unsigned long now, uint32_t duration) {
+        startMs = now;
+        durationMs = duration;
+    }
+
+    uint32_t getDurationMs() const { return durationMs; }
+
+    // Clamped to [0, duration]
+    uint32_t elapsedMs(unsigned long now) const {
+        unsigned long elapsed = ::elapsedMs(now, startMs);
+        return (elapsed < durationMs) ? elapsed : durationMs;
+    }
+
+    uint32_t remainingMs(unsigned long now) const {
+        return durationMs - elapsedMs(now);
+    }
+
+    // Rounded up: a countdown shows 5:00 until a full second has passed
+    // and reaches 0:00 exactly when it expires
+    uint32_t remainingSeconds(unsigned long now) const {
+        return (remainingMs(now) + 999) / 1000;
+    }
+
+    bool expired(unsigned long now) const {
+        return elapsedMs(now) >= durationMs;
+    }
+};
+
+#endif // TIMEKEEPING_H
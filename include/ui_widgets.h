@@ -0,0 +1,163 @@
+#ifndef UI_WIDGETS_H
+#define UI_WIDGETS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "latency_tracer.h"
+
+class DisplayManager;
+
+#define UI_MAX_WIDGETS 6      // Widgets per screen
+#define UI_CODE_MAX_LENGTH 7  // Longest code a CodeLineWidget can show
+
+// Retained UI layer on top of DisplayManager. Each widget keeps the value it
+// last drew and a dirty flag; a UiScreen only rasterizes a frame when one of
+// its widgets changed, so steady-state screens cost nothing per loop.
+
+class UiWidget {
+protected:
+    bool dirty;
+    uint16_t traceId;  // Key press whose handling changed it, see latency_tracer.h
+
+    // Value changed: redraw, and remember the press being handled, if any
+    void changed() {
+        dirty = true;
+        if (TRACE_CURRENT_CONTEXT() != 0) traceId = TRACE_CURRENT_CONTEXT();
+    }
+
+public:
+    UiWidget() : dirty(true), traceId(0) {}
+    virtual ~UiWidget() = default;
+    bool isDirty() const { return dirty; }
+    uint16_t getTraceId() const { return traceId; }
+    void markDirty() { changed(); }
+    void markClean() { dirty = false; traceId = 0; }
+    virtual void draw(DisplayManager& display) = 0;
+};
+
+// MM:SS countdown, x = TEXT_CENTERED centers it
+class TimerWidget : public UiWidget {
+private:
+    int seconds;
+    int16_t x;
+    int16_t y;
+    uint8_t size;
+
+public:
+    TimerWidget(int16_t x, int16_t y, uint8_t size);
+    void set(int timeRemaining);
+    void draw(DisplayManager& display) override;
+};
+
+// ARMED / DISARMED banner of the defuse screen
+class StatusBannerWidget : public UiWidget {
+private:
+    bool armed;
+
+public:
+    StatusBannerWidget();
+    void set(bool isArmed);
+    void draw(DisplayManager& display) override;
+};
+
+// "CODE: 1234" line, digits as entered on the keypad
+class CodeLineWidget : public UiWidget {
+private:
+    char code[UI_CODE_MAX_LENGTH + 1];
+
+public:
+    CodeLineWidget();
+    void set(const int digits[], int count);
+    void draw(DisplayManager& display) override;
+};
+
+// MISSION SUCCESS / MISSION FAILED screen of defuse mode
+class DefuseResultWidget : public UiWidget {
+private:
+    bool victory;
+
+public:
+    DefuseResultWidget();
+    void set(bool isVictory);
+    void draw(DisplayManager& display) override;
+};
+
+// RED / GREEN score line of the domination screen
+class ScorePairWidget : public UiWidget {
+private:
+    int redScore;
+    int greenScore;
+
+public:
+    ScorePairWidget();
+    void set(int red, int green);
+    void draw(DisplayManager& display) override;
+};
+
+// Flag owner line of the domination screen
+class FlagOwnerWidget : public UiWidget {
+private:
+    PointOwnership owner;
+
+public:
+    FlagOwnerWidget();
+    void set(PointOwnership currentOwner);
+    void draw(DisplayManager& display) override;
+};
+
+// Capture progress bar (0-100 percent)
+class CaptureBarWidget : public UiWidget {
+private:
+    int progress;
+
+public:
+    CaptureBarWidget();
+    void set(int captureProgress);
+    void draw(DisplayManager& display) override;
+};
+
+// Minutes selector of the domination setup screen
+class SetupTimeWidget : public UiWidget {
+private:
+    int minutes;
+
+public:
+    SetupTimeWidget();
+    void set(int gameMinutes);
+    void draw(DisplayManager& display) override;
+};
+
+// Final result of a domination match
+class DominationResultWidget : public UiWidget {
+private:
+    PointOwnership winner;
+    int redScore;
+    int greenScore;
+
+public:
+    DominationResultWidget();
+    void set(PointOwnership matchWinner, int red, int green);
+    void draw(DisplayManager& display) override;
+};
+
+// A full screen made of widgets. render() clears and redraws the frame only
+// when a widget is dirty, or when something else drew on the panel since this
+// screen was last shown.
+class UiScreen {
+private:
+    UiWidget* widgets[UI_MAX_WIDGETS];
+    uint8_t widgetCount;
+    unsigned long lastFrame;  // DisplayManager::getFrameCount() right after our last render
+    unsigned long renders;    // Frames rasterized by this screen
+
+public:
+    UiScreen();
+    void add(UiWidget* widget);
+    bool isDirty() const;
+    bool needsRender(const DisplayManager& display) const;  // Dirty, or our frame was replaced
+    void invalidate();
+    bool render(DisplayManager& display);
+    unsigned long getRenderCount() const { return renders; }
+};
+
+#endif // UI_WIDGETS_H
@@ -0,0 +1,108 @@
+#include "cue_timeline.h"
+
+// Beep interval (ms) from nothing left to the full countdown. This is the
+// old map(remaining, 0, timeLimit, 1000, 4000); bend it to change how the
+// beeping speeds up.
+static const uint16_t DEFAULT_BEEP_INTERVALS[] = {1000, 1375, 1750, 2125, 2500, 2875, 3250, 3625, 4000};
+static const CueCurve DEFAULT_CURVE = {
+    DEFAULT_BEEP_INTERVALS, sizeof(DEFAULT_BEEP_INTERVALS) / sizeof(DEFAULT_BEEP_INTERVALS[0])};
+
+// Seconds left when SOUND_WARNING plays, largest first
+static const uint16_t WARNING_MARKS_S[] = {60, 30, 10};
+static const uint8_t WARNING_MARK_COUNT = sizeof(WARNING_MARKS_S) / sizeof(WARNING_MARKS_S[0]);
+
+CueTimeline::CueTimeline() : curve(DEFAULT_CURVE), durationMs(0) {
+    clear();
+}
+
+const CueCurve& CueTimeline::defaultCurve() {
+    return DEFAULT_CURVE;
+}
+
+void CueTimeline::clear() {
+    nextBeepMs = NO_CUE;
+    nextFlashOffMs = NO_CUE;
+    nextWarning = WARNING_MARK_COUNT;
+    head = 0;
+    count = 0;
+}
+
+void CueTimeline::start(uint32_t duration) {
+    clear();
+    durationMs = duration;
+    if (duration == 0) return;
+
+    nextBeepMs = 0;  // Armed: the first beep goes right away
+    nextWarning = 0;
+    while (nextWarning < WARNING_MARK_COUNT && WARNING_MARKS_S[nextWarning] * 1000UL >= duration) {
+        nextWarning++;  // Already passed when the countdown starts
+    }
+    refill();
+}
+
+uint32_t CueTimeline::warningAt(uint8_t index) const {
+    if (index >= WARNING_MARK_COUNT) return NO_CUE;
+    return durationMs - WARNING_MARKS_S[index] * 1000UL;
+}
+
+uint16_t CueTimeline::intervalAt(uint32_t remainingMs) const {
+    uint8_t last = curve.points - 1;
+    if (durationMs == 0) return curve.intervalMs[last];
+
+    uint64_t scaled = (uint64_t)remainingMs * last;
+    uint32_t segment = scaled / durationMs;
+    if (segment >= last) return curve.intervalMs[last];
+    uint32_t part = scaled % durationMs;
+    int32_t from = curve.intervalMs[segment];
+    int32_t to = curve.intervalMs[segment + 1];
+    return from + (int64_t)(to - from) * part / durationMs;
+}
+
+// The earliest of the pending beep, flash end and warning, merged into one
+// cue when they fall on the same millisecond
+bool CueTimeline::generate(Cue& cue) {
+    uint32_t warning = warningAt(nextWarning);
+    uint32_t at = nextBeepMs;
+    if (nextFlashOffMs < at) at = nextFlashOffMs;
+    if (warning < at) at = warning;
+    if (at == NO_CUE) return false;
+
+    cue.atMs = at;
+    cue.actions = 0;
+    if (nextFlashOffMs == at) {
+        cue.actions |= CUE_FLASH_OFF;
+        nextFlashOffMs = NO_CUE;
+    }
+    if (warning == at) {
+        cue.actions |= CUE_WARNING;
+        nextWarning++;
+    }
+    if (nextBeepMs == at) {
+        uint32_t remaining = durationMs - at;
+        cue.actions |= CUE_BEEP;
+        if (remaining <= CUE_FLASH_LAST_MS) {
+            cue.actions = (cue.actions & ~CUE_FLASH_OFF) | CUE_FLASH_ON;
+            nextFlashOffMs = at + CUE_FLASH_MS;
+        }
+        uint32_t next = at + intervalAt(remaining);
+        nextBeepMs = (next < durationMs) ? next : NO_CUE;  // The explosion takes over at the end
+    }
+    return true;
+}
+
+void CueTimeline::refill() {
+    Cue cue;
+    while (count < CUE_WINDOW_SIZE && generate(cue)) {
+        window[(head + count) & (CUE_WINDOW_SIZE - 1)] = cue;
+        count++;
+    }
+}
+
+bool CueTimeline::next(uint32_t elapsedMs, Cue& cue) {
+    if (count == 0 || elapsedMs < window[head].atMs) return false;
+    cue = window[head];
+    head = (head + 1) & (CUE_WINDOW_SIZE - 1);
+    count--;
+    refill();
+    return true;
+}
@@ -1,19 +1,28 @@
 #include "display_manager.h"
 #include <Arduino.h>
 #include "game_modes.h"
+#include "text_format.h"
+#include "ui_widgets.h"
+#include "digit_atlas.h"
+#include "profiler.h"
+#include "latency_tracer.h"
 
 DisplayManager::DisplayManager() : 
 
-    display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1), initialized(false) {}
+    display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1), initialized(false), inverted(false), shadowValid(false), frameCount(0) {
+    resetFlushStats();
+}
 
 bool DisplayManager::init() {
     
     // SPI SSD1306 initialization - Add debug output
-    if(!display.begin(0x3C)){
+    if(!display.begin(OLED_I2C_ADDRESS)){
         return false;
     }
     
     initialized = true;
+    inverted = false;  // begin() leaves the panel in normal mode
+    invalidate(); // Panel RAM content is unknown after begin()
     display.clearDisplay();
     display.setTextColor(SH110X_WHITE);
     display.cp437(true); // Use full 256 char 'Code Page 437' font
@@ -21,14 +30,14 @@ bool DisplayManager::init() {
     // Test the display with a simple pattern
     display.clearDisplay();
     display.drawRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, SH110X_WHITE);
-    display.display(); // This is essential - must call display()
+    update(); // This is essential - must push the frame
     delay(1000);
     
     // Using adjusted positions for 128x64 resolution
     display.clearDisplay();
-    showCenteredText("AIRSOFT BOMB", 10, 2);
-    showCenteredText("v2.0", 32, 1);
-    display.display(); // Must call display() to update the screen
+    showCenteredLabel("AIRSOFT BOMB", 10, 2);
+    showCenteredLabel("v2.0", 32, 1);
+    update(); // Must flush to update the screen
     delay(2000);
     
     return true;
@@ -41,34 +50,118 @@ void DisplayManager::clear() {
 
 void DisplayManager::update() {
     if (!initialized) return;
-    display.display();
+    PROFILE_SCOPE(PROBE_DISPLAY_FLUSH);
+    flushDirtyPages();
+}
+
+void DisplayManager::invalidate() {
+    shadowValid = false;
+}
+
+void DisplayManager::setInverted(bool on) {
+    if (on == inverted) return;
+    inverted = on;
+    if (initialized) {
+        display.invertDisplay(on);
+    }
+}
+
+void DisplayManager::resetFlushStats() {
+    memset(&flushStats, 0, sizeof(flushStats));
+}
+
+// Compare the framebuffer against the shadow copy and send only the changed
+// column range of each page. Unchanged pages cost no I2C traffic at all.
+void DisplayManager::flushDirtyPages() {
+    const uint8_t* buffer = display.getBuffer();
+    unsigned long bytesBefore = flushStats.bytesSent;
+    flushStats.flushes++;
+    frameCount++;
+
+    for (uint8_t page = 0; page < DISPLAY_PAGES; page++) {
+        const uint8_t* row = buffer + page * SCREEN_WIDTH;
+        uint8_t* shadowRow = shadow + page * SCREEN_WIDTH;
+
+        int first = 0;
+        int last = SCREEN_WIDTH - 1;
+        if (shadowValid) {
+            while (first < SCREEN_WIDTH && row[first] == shadowRow[first]) first++;
+            if (first == SCREEN_WIDTH) {
+                flushStats.bytesSaved += SCREEN_WIDTH;
+                continue;
+            }
+            while (row[last] == shadowRow[last]) last--;
+        }
+
+        uint8_t length = last - first + 1;
+        sendPageWindow(page, first);
+        sendData(row + first, length);
+        memcpy(shadowRow + first, row + first, length);
+
+        flushStats.pagesSent++;
+        flushStats.bytesSent += length;
+        flushStats.bytesSaved += SCREEN_WIDTH - length;
+    }
+
+    shadowValid = true;
+    if (flushStats.bytesSent != bytesBefore) {
+        TRACE_PIXELS_DRAWN(0);  // Drawn while handling a press, e.g. a show* screen
+        TRACE_PIXELS_FLUSHED();
+    }
+}
+
+void DisplayManager::sendPageWindow(uint8_t page, uint8_t column) {
+    uint8_t ramColumn = column + SH1106_COLUMN_OFFSET;
+    Wire.beginTransmission(OLED_I2C_ADDRESS);
+    Wire.write((uint8_t)0x00);                      // Control byte: command stream
+    Wire.write((uint8_t)(0xB0 | page));             // Set page address
+    Wire.write((uint8_t)(ramColumn & 0x0F));        // Set lower column address
+    Wire.write((uint8_t)(0x10 | (ramColumn >> 4))); // Set higher column address
+    Wire.endTransmission();
 }
 
-void DisplayManager::showCenteredText(const String& text, int y, int size) {
+void DisplayManager::sendData(const uint8_t* data, uint8_t length) {
+    while (length > 0) {
+        uint8_t chunk = (length > I2C_CHUNK_SIZE) ? I2C_CHUNK_SIZE : length;
+        Wire.beginTransmission(OLED_I2C_ADDRESS);
+        Wire.write((uint8_t)0x40);                  // Control byte: data stream
+        Wire.write(data, chunk);
+        Wire.endTransmission();
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void DisplayManager::showCenteredText(const char* text, int y, int size) {
     if (!initialized) return;
     
-    int16_t x1, y1;
-    uint16_t w, h;
-    
+    // Fixed-width font: the width follows from the length, see text_layout.h
     display.setTextSize(size);
-    display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-    
-    display.setCursor((SCREEN_WIDTH - w) / 2, y);
+    display.setCursor(centeredTextX(strlen(text), size), y);
     display.print(text);
 }
 
+void DisplayManager::showCenteredLabel(const TextLabel& label, int y, int size) {
+    if (!initialized) return;
+    
+    // Length is a compile-time constant of the label
+    display.setTextSize(size);
+    display.setCursor(label.centeredX(size), y);
+    display.print(label.text);
+}
+
 void DisplayManager::showWelcome() {
     if (!initialized) return;
     
     clear();
     // Adjusted positions and text sizes for 64px height
-    showCenteredText("AIRSOFT BOMB", 10, 2);
-    showCenteredText("READY", 35, 1);
-    showCenteredText("Press any key", 50, 1);
+    showCenteredLabel("AIRSOFT BOMB", 10, 2);
+    showCenteredLabel("READY", 35, 1);
+    showCenteredLabel("Press any key", 50, 1);
     update();
 }
 
-void DisplayManager::showMenu(const String& title, const String items[], int numItems, int selectedIndex) {
+void DisplayManager::showMenu(const char* title, const char* const items[], int numItems, int selectedIndex) {
     if (!initialized) return;
     
     clear();
@@ -98,12 +191,14 @@ void DisplayManager::showMenu(const String& title, const String items[], int num
             display.fillRect(0, yPos - 1, SCREEN_WIDTH, 10, SH110X_WHITE);
             display.setTextColor(SH110X_BLACK);
             display.setCursor(3, yPos);
-            display.print("> " + items[i]);
+            display.print("> ");
+            display.print(items[i]);
             display.setTextColor(SH110X_WHITE);
         } else {
             // Regular item
             display.setCursor(3, yPos);
-            display.print("  " + items[i]);
+            display.print("  ");
+            display.print(items[i]);
         }
     }
     
@@ -114,18 +209,18 @@ void DisplayManager::showGameMode(GameMode mode) {
     if (!initialized) return;
     
     clear();
-    showCenteredText("GAME MODE", 2, 1);
+    showCenteredLabel("GAME MODE", 2, 1);
     // Underline adjusted
     display.drawLine(0, 12, SCREEN_WIDTH, 12, SH110X_WHITE);
     
-    String modeName = (mode == DEFUSE_MODE) ? "DEFUSE BOMB" : "DOMINATION";
+    TextLabel modeName = (mode == DEFUSE_MODE) ? TextLabel("DEFUSE BOMB") : TextLabel("DOMINATION");
     // Place mode name in the middle with larger text
-    showCenteredText(modeName, 26, 2);
+    showCenteredLabel(modeName, 26, 2);
     
     if (mode == DEFUSE_MODE) {
-        showCenteredText("Plant/defuse mission", 50, 1);
+        showCenteredLabel("Plant/defuse mission", 50, 1);
     } else {
-        showCenteredText("Control points mission", 50, 1);
+        showCenteredLabel("Control points mission", 50, 1);
     }
     
     update();
@@ -136,54 +231,22 @@ void DisplayManager::showCountdown(int timeRemaining) {
     
     clear();
     
-    // Format time as MM:SS
-    int minutes = timeRemaining / 60;
-    int seconds = timeRemaining % 60;
-    minutes = constrain(minutes, 0, 99);
-    seconds = constrain(seconds, 0, 59);
-    char timeStr[9];
-    snprintf(timeStr, sizeof(timeStr), "%02d:%02d", minutes, seconds);
-    
-    showCenteredText("COUNTDOWN", 2, 1);
+    showCenteredLabel("COUNTDOWN", 2, 1);
     display.drawLine(0, 12, SCREEN_WIDTH, 12, SH110X_WHITE);
     
     // Center the time string with large text
-    showCenteredText(timeStr, 25, 3);
+    drawTimer(timeRemaining, TEXT_CENTERED, 25, 3);
     
     update();
 }
 
-void DisplayManager::showDefuseScreen(int timeRemaining, bool armed, const String& code) {
+void DisplayManager::showDefuseScreen(int timeRemaining, bool armed, const char* code) {
     if (!initialized) return;
     
     clear();
-    
-    // Format time as MM:SS
-    int minutes = timeRemaining / 60;
-    int seconds = timeRemaining % 60;
-    minutes = constrain(minutes, 0, 99);
-    seconds = constrain(seconds, 0, 59);
-    char timeStr[9];
-    snprintf(timeStr, sizeof(timeStr), "%02d:%02d", minutes, seconds);
-    
-    // Show status at top
-    if (armed) {
-        display.fillRect(0, 0, SCREEN_WIDTH, 16, SH110X_WHITE);
-        display.setTextColor(SH110X_BLACK);
-        showCenteredText("ARMED", 4, 2);
-        display.setTextColor(SH110X_WHITE);
-    } else {
-        showCenteredText("DISARMED", 4, 2);
-    }
-    
-    // Show time with large font
-    showCenteredText(timeStr, 26, 3);
-    
-    // Show code if available
-    if (code.length() > 0) {
-        showCenteredText("CODE: " + code, 52, 1);
-    }
-    
+    drawDefuseStatus(armed);
+    drawTimer(timeRemaining, TEXT_CENTERED, 26, 3);
+    drawCodeLine(code);
     update();
 }
 
@@ -192,24 +255,21 @@ void DisplayManager::showDominationScreen(int redScore, int blueScore, int thres
     
     clear();
     
-    showCenteredText("DOMINATION", 2, 1);
+    showCenteredLabel("DOMINATION", 2, 1);
     display.drawLine(0, 12, SCREEN_WIDTH, 12, SH110X_WHITE);
     
     // Determine leading team
-    String status;
     if (redScore > blueScore) {
-        status = "RED LEAD";
+        showCenteredLabel("RED LEAD", 18, 2);
     } else if (blueScore > redScore) {
-        status = "BLUE LEAD";
+        showCenteredLabel("BLUE LEAD", 18, 2);
     } else {
-        status = "TIED";
+        showCenteredLabel("TIED", 18, 2);
     }
     
-    showCenteredText(status, 18, 2);
-    
     // Show scores
     char scoreText[20];
-    sprintf(scoreText, "R:%d  B:%d", redScore, blueScore);
+    FORMAT_TEXT(scoreText, "R:%d  B:%d", redScore, blueScore);
     showCenteredText(scoreText, 38, 1);
     
     // Draw progress bars
@@ -233,24 +293,16 @@ void DisplayManager::showGameOver(bool victory) {
     if (!initialized) return;
     
     clear();
-    
-    showCenteredText("MISSION", 15, 2);
-    
-    if (victory) {
-        showCenteredText("SUCCESS", 40, 2);
-    } else {
-        showCenteredText("FAILED", 40, 2);
-    }
-    
+    drawGameOver(victory);
     update();
 }
 
-void DisplayManager::showSettings(const String& setting, const String& value) {
+void DisplayManager::showSettings(const char* setting, const char* value) {
     if (!initialized) return;
     
     clear();
     
-    showCenteredText("SETTINGS", 2, 1);
+    showCenteredLabel("SETTINGS", 2, 1);
     display.drawLine(0, 12, SCREEN_WIDTH, 12, SH110X_WHITE);
     
     showCenteredText(setting, 24, 1);
@@ -259,22 +311,21 @@ void DisplayManager::showSettings(const String& setting, const String& value) {
     update();
 }
 
-void DisplayManager::showPassword(const String& password, bool hidden) {
+void DisplayManager::showPassword(const char* password, bool hidden) {
     if (!initialized) return;
     
     clear();
     
-    showCenteredText("ENTER CODE", 2, 1);
+    showCenteredLabel("ENTER CODE", 2, 1);
     display.drawLine(0, 12, SCREEN_WIDTH, 12, SH110X_WHITE);
     
-    String displayText;
-    if (hidden) {
-        for (unsigned int i = 0; i < password.length(); i++) {
-            displayText += "*";
-        }
-    } else {
-        displayText = password;
+    char displayText[11];  // Widest string that fits at text size 2
+    size_t length = 0;
+    while (password[length] != '\0' && length < sizeof(displayText) - 1) {
+        displayText[length] = hidden ? '*' : password[length];
+        length++;
     }
+    displayText[length] = '\0';
     
     showCenteredText(displayText, 32, 2);
     
@@ -286,11 +337,11 @@ void DisplayManager::showBatteryStatus(float voltage) {
     
     clear();
     
-    showCenteredText("BATTERY", 2, 1);
+    showCenteredLabel("BATTERY", 2, 1);
     display.drawLine(0, 12, SCREEN_WIDTH, 12, SH110X_WHITE);
     
     char voltStr[10];
-    sprintf(voltStr, "%.2fV", (double)voltage);
+    FORMAT_TEXT(voltStr, "%.2fV", (double)voltage);
     
     showCenteredText(voltStr, 28, 2);
     
@@ -313,19 +364,160 @@ void DisplayManager::showBatteryStatus(float voltage) {
     update();
 }
 
-void DisplayManager::showError(const String& message) {
+void DisplayManager::showError(const char* message) {
     if (!initialized) return;
     
     clear();
     
-    showCenteredText("ERROR", 10, 2);
+    showCenteredLabel("ERROR", 10, 2);
     showCenteredText(message, 36, 1);
     
     update();
 }
 
 void DisplayManager::showDominationSetup(int minutes) {
-  display.clearDisplay();
+  clear();
+  drawDominationSetup(minutes);
+  update();
+}
+
+void DisplayManager::showDominationScreen(int redScore, int greenScore, int captureProgress, 
+                                        PointOwnership currentOwner, int remainingTime) {
+  clear();
+  drawTimer(remainingTime, 30, 0, 2);
+  drawScorePair(redScore, greenScore);
+  drawFlagOwner(currentOwner);
+  drawCaptureBar(captureProgress);
+  update();
+}
+
+void DisplayManager::showDominationGameOver(PointOwnership winner, int redScore, int greenScore) {
+  clear();
+  drawDominationGameOver(winner, redScore, greenScore);
+  update();
+}
+
+// Drawing primitives used by the show* screens and the retained widgets in
+// ui_widgets.h. They only rasterize into the framebuffer: no clear, no flush.
+
+void DisplayManager::formatTime(char (&buffer)[TIME_TEXT_SIZE], int timeRemaining) {
+    // Format time as MM:SS
+    int minutes = timeRemaining / 60;
+    int seconds = timeRemaining % 60;
+    minutes = constrain(minutes, 0, 99);
+    seconds = constrain(seconds, 0, 59);
+    FORMAT_TEXT(buffer, "%02d:%02d", minutes, seconds);
+}
+
+void DisplayManager::drawTimer(int timeRemaining, int16_t x, int16_t y, uint8_t size) {
+    if (!initialized) return;
+    
+    char timeStr[TIME_TEXT_SIZE];
+    formatTime(timeStr, timeRemaining);
+    
+    if (x == TEXT_CENTERED) {
+        x = centeredTextX(strlen(timeStr), size);
+    }
+    
+    // Large sizes come from the pre-scaled atlas, anything else through GFX
+    if (!drawAtlasText(timeStr, x, y, size)) {
+        display.setTextSize(size);
+        display.setCursor(x, y);
+        display.print(timeStr);
+    }
+}
+
+// Copy "MM:SS" from the PROGMEM atlas straight into the framebuffer instead
+// of letting Adafruit_GFX issue one fillRect per scaled font pixel.
+// Returns false when the size has no atlas or the text has other characters.
+bool DisplayManager::drawAtlasText(const char* text, int16_t x, int16_t y, uint8_t size) {
+    const uint8_t* atlas;
+    if (size == 2) {
+        atlas = &DIGIT_ATLAS_2X[0][0][0];
+    } else if (size == 3) {
+        atlas = &DIGIT_ATLAS_3X[0][0][0];
+    } else {
+        return false;
+    }
+    
+    for (const char* c = text; *c; c++) {
+        if ((*c < '0' || *c > '9') && *c != ':') return false;
+    }
+    
+    uint8_t width = FONT_GLYPH_WIDTH * size;
+    uint16_t glyphBytes = width * size;  // size pages per glyph
+    for (const char* c = text; *c; c++) {
+        uint8_t index = (*c == ':') ? DIGIT_ATLAS_COLON : (*c - '0');
+        blitGlyph(atlas + index * glyphBytes, width, size, x, y);
+        x += width;
+    }
+    return true;
+}
+
+void DisplayManager::blitGlyph(const uint8_t* glyph, uint8_t width, uint8_t pages, int16_t x, int16_t y) {
+    uint8_t* buffer = display.getBuffer();
+    int16_t firstPage = y >> 3;
+    uint8_t shift = y & 7;
+    
+    for (uint8_t p = 0; p < pages; p++) {
+        int16_t page = firstPage + p;
+        for (uint8_t c = 0; c < width; c++) {
+            int16_t column = x + c;
+            if (column < 0 || column >= SCREEN_WIDTH) continue;
+            
+            uint8_t bits = pgm_read_byte(glyph + p * width + c);
+            if (bits == 0) continue;
+            
+            // Page-aligned rows are a plain byte copy, otherwise the column
+            // byte straddles two pages
+            if (page >= 0 && page < DISPLAY_PAGES) {
+                buffer[page * SCREEN_WIDTH + column] |= bits << shift;
+            }
+            if (shift != 0 && page + 1 >= 0 && page + 1 < DISPLAY_PAGES) {
+                buffer[(page + 1) * SCREEN_WIDTH + column] |= bits >> (8 - shift);
+            }
+        }
+    }
+}
+
+void DisplayManager::drawDefuseStatus(bool armed) {
+    if (!initialized) return;
+    
+    // Show status at top
+    if (armed) {
+        display.fillRect(0, 0, SCREEN_WIDTH, 16, SH110X_WHITE);
+        display.setTextColor(SH110X_BLACK);
+        showCenteredLabel("ARMED", 4, 2);
+        display.setTextColor(SH110X_WHITE);
+    } else {
+        showCenteredLabel("DISARMED", 4, 2);
+    }
+}
+
+void DisplayManager::drawCodeLine(const char* code) {
+    if (!initialized) return;
+    
+    // Show code if available
+    if (code[0] != '\0') {
+        char codeText[UI_CODE_MAX_LENGTH + 7];  // "CODE: " + digits
+        FORMAT_TEXT(codeText, "CODE: %s", code);
+        showCenteredText(codeText, 52, 1);
+    }
+}
+
+void DisplayManager::drawGameOver(bool victory) {
+    if (!initialized) return;
+    
+    showCenteredLabel("MISSION", 15, 2);
+    
+    if (victory) {
+        showCenteredLabel("SUCCESS", 40, 2);
+    } else {
+        showCenteredLabel("FAILED", 40, 2);
+    }
+}
+
+void DisplayManager::drawDominationSetup(int minutes) {
   display.setTextSize(1);
   display.setCursor(0, 0);
   display.println("DOMINATION SETUP");
@@ -336,33 +528,16 @@ void DisplayManager::showDominationSetup(int minutes) {
   
   display.setTextSize(3);
   char timeStr[10];
-  sprintf(timeStr, "%d min", minutes);
+  FORMAT_TEXT(timeStr, "%d min", minutes);
   display.println(timeStr);
   
   display.setTextSize(1);
   display.println("");
   display.println("Green: +5 min  Red: -5 min");
   display.println("# to start");
-  
-  display.display();
 }
 
-void DisplayManager::showDominationScreen(int redScore, int greenScore, int captureProgress, 
-                                        PointOwnership currentOwner, int remainingTime) {
-  display.clearDisplay();
-  
-  // Show timer at top
-  int minutes = remainingTime / 60;
-  int seconds = remainingTime % 60;
-  minutes = constrain(minutes, 0, 99);
-  seconds = constrain(seconds, 0, 59);
-  char timeStr[10];
-  snprintf(timeStr, sizeof(timeStr), "%02d:%02d", minutes, seconds);
-  
-  display.setTextSize(2);
-  display.setCursor(30, 0);
-  display.println(timeStr);
-  
+void DisplayManager::drawScorePair(int redScore, int greenScore) {
   // Show team scores
   display.setTextSize(1);
   display.setCursor(0, 20);
@@ -372,8 +547,11 @@ void DisplayManager::showDominationScreen(int redScore, int greenScore, int capt
   display.setCursor(70, 20);
   display.print("GREEN: ");
   display.print(greenScore);
-  
-  // Show flag ownership and capture progress
+}
+
+void DisplayManager::drawFlagOwner(PointOwnership currentOwner) {
+  // Show flag ownership
+  display.setTextSize(1);
   display.setCursor(0, 32);
   switch (currentOwner) {
     case RED_TEAM:
@@ -386,7 +564,9 @@ void DisplayManager::showDominationScreen(int redScore, int greenScore, int capt
       display.println("Flag: NEUTRAL");
       break;
   }
-  
+}
+
+void DisplayManager::drawCaptureBar(int captureProgress) {
   // Draw capture progress bar
   display.drawRect(0, 44, 128, 10, SH110X_WHITE); // Changed WHITE to SH110X_WHITE
   
@@ -396,13 +576,9 @@ void DisplayManager::showDominationScreen(int redScore, int greenScore, int capt
     int width = (captureProgress * 126) / 100;
     display.fillRect(1, 45, width, 8, SH110X_WHITE); // Changed WHITE to SH110X_WHITE
   }
-  
-  display.display();
 }
 
-void DisplayManager::showDominationGameOver(PointOwnership winner, int redScore, int greenScore) {
-  display.clearDisplay();
-  
+void DisplayManager::drawDominationGameOver(PointOwnership winner, int redScore, int greenScore) {
   display.setTextSize(2);
   display.setCursor(0, 0);
   display.println("GAME OVER");
@@ -436,6 +612,4 @@ void DisplayManager::showDominationGameOver(PointOwnership winner, int redScore,
   display.setTextSize(1);
   display.println("");
   display.println("Press # to restart");
-  
-  display.display();
-}
\ No newline at end of file
+}
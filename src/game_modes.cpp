@@ -2,16 +2,62 @@
 #include <Arduino.h> // Add this to get millis()
 #include <display_manager.h>
 #include <sound_manager.h>
+#include "latency_tracer.h"
 
 // GameBase implementation
-GameBase::GameBase()
+GameBase::GameBase() : clock(&systemClock())
 {
     // Base constructor implementation
 }
 
+void GameBase::tick(unsigned long nowMs)
+{
+    if (!ticking)
+    {
+        // Start the timeline at the first tick instead of catching up from 0
+        tickTime = nowMs;
+        ticking = true;
+    }
+
+    while (timeDiff(nowMs, tickTime) >= GAME_TICK_MS)
+    {
+        tickTime += GAME_TICK_MS;
+        update();
+    }
+
+    // Inputs handled outside processKeyEvents() are stamped with game time
+    eventTime = tickTime;
+}
+
+void GameBase::processKeyEvents(KeyEventQueue& queue)
+{
+    KeyEvent event;
+    while (queue.pop(event))
+    {
+        eventTime = event.timestamp;
+        TRACE_KEY_HANDLED(event.id);
+        TRACE_CONTEXT(event.id);
+        handleKeyEvent(event);
+        showInput();
+        TRACE_CONTEXT_END();
+    }
+}
+
+void GameBase::handleKeyEvent(const KeyEvent& event)
+{
+    if (event.type == KEY_PRESS)
+    {
+        handleButton(event.key);
+    }
+}
+
 // DefuseMode implementation
-DefuseMode::DefuseMode()
+DefuseMode::DefuseMode() : timerWidget(TEXT_CENTERED, 26, 3)
 {
+    view.add(&statusWidget);
+    view.add(&timerWidget);
+    view.add(&codeWidget);
+    resultView.add(&resultWidget);
     reset();
 }
 
@@ -21,53 +67,122 @@ void DefuseMode::init()
 }
 
 void DefuseMode::update() {
+    unsigned long now = tickTime;
+
     if (state == WAITING_TO_ARM) {
         // Show DISARMED screen with code input
-        String codeStr = "";
-        for (int i = 0; i < codePosition; i++) {
-            codeStr += String(inputCode[i]);
-        }
-        display->showDefuseScreen(timeLimit, false, codeStr);
+        updateWidgets(timeLimit);
+        return;
+    }
+
+    if (updateResult(now)) {
         return;
     }
 
     // If ARMED
-    unsigned long now = millis();
-    unsigned long elapsed = (now - startTime) / 1000;
-    int remaining = timeLimit - elapsed;
+    int remaining = fuse.remainingSeconds(now);
 
     // Explosion triggered
-    if (remaining <= 0) {
+    if (fuse.expired(now)) {
         sound->play(SOUND_EXPLOSION);  // Make sure you mapped this to 0002.mp3 or similar
-        display->showGameOver(false);  // Mission failed
-        delay(5000);
-        reset();
+        enterState(EXPLODED, now);     // Mission failed, screen stays up while the loop runs
         return;
     }
 
     // Show countdown + code
-    String codeStr = "";
-    for (int i = 0; i < codePosition; i++) {
-        codeStr += String(inputCode[i]);
+    updateWidgets(remaining);
+
+    // Cues due by now, including any a late step missed
+    Cue cue;
+    while (cues.next(fuse.elapsedMs(now), cue)) {
+        if (cue.actions & CUE_BEEP) sound->play(SOUND_TIME);  // 0003.mp3
+        if (cue.actions & CUE_WARNING) sound->play(SOUND_WARNING);
+        if (cue.actions & CUE_FLASH_ON) flashOn = true;
+        if (cue.actions & CUE_FLASH_OFF) flashOn = false;
     }
-    display->showDefuseScreen(remaining, true, codeStr);
+}
 
-    // Calculate dynamic beep interval: faster when closer to zero
-    int interval = map(remaining, 0, timeLimit, 1000, 4000); // From 1000ms (urgent) to 4000ms (chill)
+// Game over runs on timestamps instead of delay(): EXPLODED/DEFUSED hold the
+// result screen until DEFUSE_RESULT_MS passed or a key dismissed it, then
+// COOLDOWN swallows the tail of that key before the game resets.
+// Returns false while the game is still being played.
+bool DefuseMode::updateResult(unsigned long now) {
+    switch (state) {
+        case EXPLODED:
+        case DEFUSED:
+            if (elapsedMs(now, stateTime) >= DEFUSE_RESULT_MS) {
+                enterState(COOLDOWN, now);
+            }
+            return true;
+        case COOLDOWN:
+            if (elapsedMs(now, stateTime) >= DEFUSE_COOLDOWN_MS) {
+                reset();
+            }
+            return true;
+        default:
+            return false;
+    }
+}
 
-    // Play beep if interval passed
-    if (now - lastBeepTime >= interval) {
-        sound->play(SOUND_TIME);  // 0003.mp3
-        lastBeepTime = now;
+void DefuseMode::enterState(DefuseState next, unsigned long now) {
+    state = next;
+    stateTime = now;
+    cues.clear();
+    flashOn = false;
+    if (next == EXPLODED || next == DEFUSED) {
+        resultWidget.set(next == DEFUSED);
+        resultView.invalidate();
     }
 }
 
+// Feed the current model into the widgets; a frame is only rasterized
+// when the status, the displayed second or the entered code changed
+void DefuseMode::updateWidgets(int timeRemaining) {
+    statusWidget.set(state == ARMED);
+    timerWidget.set(timeRemaining);
+    codeWidget.set(inputCode, codePosition);
+}
+
+// The status and code lines right away, so the widgets a press changed are
+// attributed to it; the timer keeps following update()
+void DefuseMode::showInput() {
+    statusWidget.set(state == ARMED);
+    codeWidget.set(inputCode, codePosition);
+}
+
+UiScreen& DefuseMode::currentView() {
+    if (state == EXPLODED || state == DEFUSED || state == COOLDOWN) {
+        return resultView;
+    }
+    return view;
+}
+
+void DefuseMode::render() {
+    display->setInverted(flashOn);
+    currentView().render(*display);
+}
+
+bool DefuseMode::needsRender() {
+    return currentView().needsRender(*display) || display->isInverted() != flashOn;
+}
+
 void DefuseMode::setManagers(DisplayManager* d, SoundManager* s) {
     display = d;
     sound = s;
 }
 
 void DefuseMode::handleInput(int button) {
+    if (state == EXPLODED || state == DEFUSED) {
+        // Any key skips the result screen once the guard time is over
+        if (elapsedMs(eventTime, stateTime) >= DEFUSE_DISMISS_GUARD_MS) {
+            enterState(COOLDOWN, eventTime);
+        }
+        return;
+    }
+    if (state == COOLDOWN) {
+        return;
+    }
+
     if (button >= 0 && button <= 9) {
         if (codePosition < 4) {
             inputCode[codePosition++] = button;
@@ -99,17 +214,14 @@ void DefuseMode::handleInput(int button) {
 
         if (correct) {
             if (state == WAITING_TO_ARM) {
+                // Count down from the moment '#' went down, not from when
+                // the loop got around to handling it
                 state = ARMED;
-                startTime = millis();
-
-        
+                fuse.start(eventTime, (uint32_t)timeLimit * 1000);
+                cues.start(fuse.getDurationMs());
             } else if (state == ARMED) {
-                state = WAITING_TO_ARM;
-
-                display->showGameOver(true);  // Victory
-
-                delay(5000);
-                reset();
+                sound->play(SOUND_DEFUSED);
+                enterState(DEFUSED, eventTime);  // Victory
             }
         }
 
@@ -119,17 +231,23 @@ void DefuseMode::handleInput(int button) {
 
 bool DefuseMode::isGameOver()
 {
-    // Game over logic for defuse mode
-    return false;
+    return state == EXPLODED || state == DEFUSED || state == COOLDOWN;
 }
 
 void DefuseMode::reset() {
-    startTime = 0;
+    fuse = Countdown();
+    cues.clear();
+    flashOn = false;
     timeLimit = 300; // 5 min default
     codePosition = 0;
     state = WAITING_TO_ARM;
 }
 
+int DefuseMode::getRemainingTime() const {
+    if (state == WAITING_TO_ARM) return timeLimit;
+    return fuse.remainingSeconds(tickTime);
+}
+
 void DefuseMode::setTimeLimit(int seconds)
 {
     timeLimit = seconds;
@@ -154,8 +272,14 @@ void DefuseMode::handleButton(char button)
 }
 
 // DominationMode implementation
-DominationMode::DominationMode()
+DominationMode::DominationMode() : timerWidget(30, 0, 2)
 {
+    setupView.add(&setupWidget);
+    runningView.add(&timerWidget);
+    runningView.add(&scoreWidget);
+    runningView.add(&ownerWidget);
+    runningView.add(&captureWidget);
+    resultView.add(&resultWidget);
     reset();
 }
 
@@ -173,39 +297,70 @@ void DominationMode::update()
 {
     if (state == SETUP)
     {
-        display->showDominationSetup(getGameTime() / 60);
+        setupWidget.set(getGameTime() / 60);
     }
 
     if (state == RUNNING)
     {
-        unsigned long currentTime = millis();
+        unsigned long currentTime = tickTime;
 
         // Update elapsed time
-        elapsedTime = (currentTime - startTime) / 1000; // Convert to seconds
+        elapsedTime = matchTimer.elapsedMs(currentTime) / 1000; // Convert to seconds
 
-        updateCapture();
+        // Credit the time up to now to the owner before a capture can change it
         updateScores();
+        updateCapture();
 
-        int remainingTime = gameTime - elapsedTime;
+        int remainingTime = matchTimer.remainingSeconds(currentTime);
         int captureProgress = getCaptureProgress();
         PointOwnership owner = getCurrentOwner();
 
-        display->showDominationScreen(redScore, greenScore, captureProgress, owner, remainingTime);
+        timerWidget.set(remainingTime);
+        scoreWidget.set(redScore, greenScore);
+        ownerWidget.set(owner);
+        captureWidget.set(captureProgress);
 
-        if (elapsedTime >= gameTime)
+        if (matchTimer.expired(currentTime))
         {
             state = GAME_OVER;
-            return;
         }
     }
-    else if (state == GAME_OVER)
+
+    // Also right after the transition, so the result screen never shows stale scores
+    if (state == GAME_OVER)
     {
-        PointOwnership winner = (redScore > greenScore) ? RED_TEAM :
-                                (greenScore > redScore) ? GREEN_TEAM : NEUTRAL;
-        display->showDominationGameOver(winner, redScore, greenScore);
+        // Decided on exact hold time, not on the rounded seconds shown
+        uint32_t redMs = redHeld.getMs();
+        uint32_t greenMs = greenHeld.getMs();
+        PointOwnership winner = (redMs > greenMs) ? RED_TEAM :
+                                (greenMs > redMs) ? GREEN_TEAM : NEUTRAL;
+        resultWidget.set(winner, redScore, greenScore);
     }
 }
 
+UiScreen& DominationMode::currentView()
+{
+    if (state == RUNNING)
+    {
+        return runningView;
+    }
+    if (state == GAME_OVER)
+    {
+        return resultView;
+    }
+    return setupView;
+}
+
+void DominationMode::render()
+{
+    currentView().render(*display);
+}
+
+bool DominationMode::needsRender()
+{
+    return currentView().needsRender(*display);
+}
+
 void DominationMode::handleInput(int button)
 {
     // Handle input logic for domination mode
@@ -221,22 +376,40 @@ bool DominationMode::isGameOver()
 
 void DominationMode::reset()
 {
-    gameTime = DOM_DEFAULT_TIME * 60; // Convert to seconds
-    startTime = 0;
+    gameTime = defaultGameTime;
+    matchTimer = Countdown();
     elapsedTime = 0;
     currentOwner = NEUTRAL;
     captureStartTime = 0;
+    captureRunning = false;
     capturingTeam = NEUTRAL;
     captureProgress = 0;
     redScore = 0;
     greenScore = 0;
-    lastScoreUpdate = 0;
+    redHeld.reset();
+    greenHeld.reset();
+    scoredMs = 0;
     setupComplete = false;
     state = SETUP;
     redButtonHeld = false;
     greenButtonHeld = false;
 }
 
+int DominationMode::getRemainingTime() const
+{
+    if (state == SETUP) return gameTime;
+    return matchTimer.remainingSeconds(tickTime);
+}
+
+void DominationMode::setDefaultGameTime(unsigned long seconds)
+{
+    defaultGameTime = seconds;
+    if (state == SETUP)
+    {
+        gameTime = seconds;
+    }
+}
+
 void DominationMode::setWinThreshold(int seconds)
 {
     // You could implement this if needed
@@ -244,21 +417,25 @@ void DominationMode::setWinThreshold(int seconds)
 
 void DominationMode::updateScores()
 {
-    unsigned long currentTime = millis();
-
-    // Update scores once per second
-    if (currentTime - lastScoreUpdate >= 1000)
+    // Credit the match time since the last call to the current owner. The
+    // match timer stops at the end of the match, so no time is credited
+    // past it, and nothing is lost between calls however they are spaced.
+    uint32_t matchMs = matchTimer.elapsedMs(tickTime);
+    uint32_t slice = matchMs - scoredMs;
+    scoredMs = matchMs;
+
+    if (currentOwner == RED_TEAM)
     {
-        if (currentOwner == RED_TEAM)
-        {
-            redScore++;
-        }
-        else if (currentOwner == GREEN_TEAM)
-        {
-            greenScore++;
-        }
-        lastScoreUpdate = currentTime;
+        redHeld.add(slice);
     }
+    else if (currentOwner == GREEN_TEAM)
+    {
+        greenHeld.add(slice);
+    }
+
+    // Whole seconds owned, the remainder carries over
+    redScore = redHeld.getSeconds();
+    greenScore = greenHeld.getSeconds();
 }
 
 void DominationMode::updateCapture()
@@ -280,10 +457,10 @@ void DominationMode::updateCapture()
     }
 
     // Continue with capture progress if we have a start time
-    if (captureStartTime > 0)
+    if (captureRunning)
     {
-        unsigned long currentTime = millis();
-        unsigned long captureDuration = currentTime - captureStartTime;
+        unsigned long currentTime = tickTime;
+        unsigned long captureDuration = elapsedMs(currentTime, captureStartTime);
 
         // Calculate progress percentage
         int oldProgress = captureProgress;
@@ -294,7 +471,7 @@ void DominationMode::updateCapture()
         {
             captureProgress = 100;
             currentOwner = capturingTeam;
-            captureStartTime = 0; // Reset capture timer
+            captureRunning = false; // Reset capture timer
         }
     }
 }
@@ -307,8 +484,8 @@ void DominationMode::handleButton(char button)
         if (button == '#')
         {
             // Start game
-            startTime = millis();
-            lastScoreUpdate = startTime;
+            matchTimer.start(tickTime, gameTime * 1000);
+            scoredMs = 0;
             state = RUNNING;
         }
         else if (button == 'R')
@@ -369,11 +546,16 @@ void DominationMode::setupGameTime(bool increase)
     }
     else
     {
-        gameTime -= DOM_TIME_INCREMENT * 60; // Subtract 5 minutes
-        if (gameTime < DOM_MIN_TIME * 60)
+        // Clamp before subtracting: gameTime is unsigned and the default is
+        // below one increment
+        if (gameTime < (DOM_MIN_TIME + DOM_TIME_INCREMENT) * 60)
         {
             gameTime = DOM_MIN_TIME * 60;
         }
+        else
+        {
+            gameTime -= DOM_TIME_INCREMENT * 60; // Subtract 5 minutes
+        }
     }
 }
 
@@ -382,7 +564,8 @@ void DominationMode::startCapture(PointOwnership team)
     // Start capturing for the indicated team
     if (currentOwner != team)
     {
-        captureStartTime = millis();
+        captureStartTime = inputTime();
+        captureRunning = true;
         captureProgress = 0;
     }
 }
@@ -400,10 +583,11 @@ void DominationMode::updateButtonStates(bool redPressed, bool greenPressed)
     if (redButtonHeld && currentOwner != RED_TEAM)
     {
         // Continue red capture
-        if (captureStartTime == 0 || capturingTeam != RED_TEAM)
+        if (!captureRunning || capturingTeam != RED_TEAM)
         { // ← CRITICAL CHANGE: check if capture not started
             // Start new capture
-            captureStartTime = millis();
+            captureStartTime = inputTime();
+            captureRunning = true;
             capturingTeam = RED_TEAM;
         }
         // Else continue existing capture (no change needed)
@@ -411,21 +595,24 @@ void DominationMode::updateButtonStates(bool redPressed, bool greenPressed)
     else if (greenButtonHeld && currentOwner != GREEN_TEAM)
     {
         // Continue green capture
-        if (captureStartTime == 0 || capturingTeam != GREEN_TEAM)
+        if (!captureRunning || capturingTeam != GREEN_TEAM)
         { // ← CRITICAL CHANGE: check if capture not started
             // Start new capture
-            captureStartTime = millis();
+            captureStartTime = inputTime();
+            captureRunning = true;
             capturingTeam = GREEN_TEAM;
         }
         // Else continue existing capture (no change needed)
     }
     else
     {
-        // No buttons held or trying to capture already-owned point
-        if (captureProgress > 0 && captureProgress < 100)
+        // No buttons held or trying to capture already-owned point.
+        // Test the timer, not the progress: a hold shorter than one game
+        // step leaves progress at 0 with the timer still running.
+        if (captureRunning)
         {
             captureProgress = 0;
-            captureStartTime = 0;
+            captureRunning = false;
         }
     }
 }
@@ -1,4 +1,7 @@
 #include "keypad_manager.h"
+#include "latency_tracer.h"
+
+volatile bool KeypadManager::changePending = true;
 
 KeypadManager::KeypadManager(uint8_t address) : i2cAddress(address), portState(0xFF) {
     // Constructor - initialize port state to all HIGH (inputs with pull-ups)
@@ -9,9 +12,11 @@ void KeypadManager::writePort(uint8_t value) {
     Wire.write(value);
     Wire.endTransmission();
     portState = value;
+    scanTransactions++;
 }
 
 uint8_t KeypadManager::readPort() {
+    scanTransactions++;
     Wire.requestFrom(i2cAddress, (uint8_t)1);
     if (Wire.available()) {
         return Wire.read();
@@ -19,141 +24,227 @@ uint8_t KeypadManager::readPort() {
     return 0xFF;  // Default to all HIGH if read fails
 }
 
-void KeypadManager::pinMode_I2C(uint8_t pin, uint8_t mode) {
-    // For PCF8574, pins are inputs when HIGH and outputs when LOW
-    if (mode == INPUT || mode == INPUT_PULLUP) {
-        // Set pin HIGH for input with pull-up
-        portState |= (1 << pin);  // Set bit to 1
-    } else {
-        // No specific action needed for OUTPUT as we'll control the pin state
-        // when we write to it
+void KeypadManager::drivePort(uint8_t value) {
+    if (value != portState) {
+        writePort(value);
     }
-    writePort(portState);
 }
 
-void KeypadManager::digitalWrite_I2C(uint8_t pin, uint8_t value) {
-    if (value == HIGH) {
-        portState |= (1 << pin);  // Set bit to 1
-    } else {
-        portState &= ~(1 << pin); // Clear bit to 0
-    }
-    writePort(portState);
+void KeypadManager::init() {
+    // Rows LOW, columns pulled up: the idle pattern the scan starts from.
+    // In this pattern a key press pulls a column LOW, which is an input
+    // change for the PCF8574 and asserts /INT.
+    writePort(KEYPAD_DRIVE_ROWS);
+    debouncer.reset();
+    edgePending = 0;
+    repeatKey = -1;
+
+#if KEYPAD_USE_INTERRUPT
+    pinMode(PIN_KEYPAD_INT, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(PIN_KEYPAD_INT), onExpanderInterrupt, FALLING);
+#endif
+    changePending = true;  // Always take a first sample
 }
 
-uint8_t KeypadManager::digitalRead_I2C(uint8_t pin) {
-    uint8_t portValue = readPort();
-    uint8_t result = (portValue & (1 << pin)) ? HIGH : LOW;
+void IRAM_ATTR KeypadManager::onExpanderInterrupt() {
+    changePending = true;
+}
 
-    return result;
+// Whether this call has to talk to the expander. Samples are never taken
+// faster than KEYPAD_SAMPLE_MS, so debounce time does not depend on how often
+// the loop calls us. In interrupt mode the bus also stays quiet until /INT
+// fired, except while a key is mid-debounce and for the safety poll. A held
+// key stays quiet too: see rearmInterrupt().
+bool KeypadManager::needsBusScan(unsigned long now) const {
+    if (now - lastBusScan < KEYPAD_SAMPLE_MS) return false;
+#if KEYPAD_USE_INTERRUPT
+    if (changePending || debouncer.isSettling()) return true;
+    return now - lastBusScan >= KEYPAD_SAFETY_POLL_MS;
+#else
+    return true;
+#endif
 }
 
-void KeypadManager::init() {
- 
+void KeypadManager::resetScanStats() {
+    maxScanMicros = 0;
+    totalScans = 0;
+    totalTransactions = 0;
+    skippedScans = 0;
+}
+
+// Never blocks: samples the matrix with the inversion scan and feeds the
+// sample to the debouncer. Every edge is queued as a timestamped KeyEvent
+// (see getEvents()); the return value is a key pressed in this call, if any.
+char KeypadManager::scanKeypad() {
+    unsigned long startMicros = micros();
+    unsigned long now = millis();
+    scanTransactions = 0;
+    char key = 0;
     
-    // Initial state - all pins HIGH (inputs with pull-ups)
-    writePort(0xFF);
-   
+    if (needsBusScan(now)) {
+        // Clear before reading: the read re-arms /INT, a later edge sets it again
+        changePending = false;
+        lastBusScan = now;
+        uint16_t sample = sampleMatrix();
+#if KEYPAD_USE_INTERRUPT
+        if (idleColumns != 0) rearmInterrupt();
+#endif
+        key = applySample(sample, now);
+    } else {
+        skippedScans++;
+    }
     
-    // Initialize row pins as output and set to HIGH
-    for (int i = 0; i < 4; i++) {
-        pinMode_I2C(rowPins[i], OUTPUT);
-        digitalWrite_I2C(rowPins[i], HIGH);
+    // Long-press and repeat timing runs even when the bus was skipped
+    updateHeldKey(now);
+    
+    lastScanMicros = micros() - startMicros;
+    if (lastScanMicros > maxScanMicros) {
+        maxScanMicros = lastScanMicros;
     }
-  
-    // Initialize column pins as input with pull-up resistors
-    for (int i = 0; i < 3; i++) {
-        pinMode_I2C(colPins[i], INPUT_PULLUP);
-
+    lastScanTransactions = scanTransactions;
+    totalScans++;
+    totalTransactions += scanTransactions;
+    
+    return key;
+}
 
+// A scan that found a column LOW wrote the port, and with a key held its own
+// writes change the inputs and pull /INT LOW again, which would rescan every
+// KEYPAD_SAMPLE_MS for as long as the key is down. One more read, in the
+// idle pattern the scan left, releases /INT. Columns that differ from the
+// sample are a real edge since, so that keeps the next scan due.
+void KeypadManager::rearmInterrupt() {
+    changePending = false;
+    uint8_t colBits = ~readPort() & KEYPAD_COL_MASK;
+    if (colBits != idleColumns) {
+        changePending = true;
     }
-
 }
 
-char KeypadManager::scanKeypad() {
-    char key = 0;
-    static unsigned long lastDebugTime = 0;
-    bool debugThisScan = (millis() - lastDebugTime) > 5000; // Debug output every 5 seconds
-  
-    if (debugThisScan) {
-
-        lastDebugTime = millis();
+// Row/column inversion scan. With the rows driven LOW a pressed key pulls its
+// column LOW; with the columns driven LOW it pulls its row LOW. The port is
+// left in the rows-LOW pattern, so an idle scan is a single port read and a
+// single key costs two write/read pairs. Returns a mask of KEYPAD_KEYS bits.
+uint16_t KeypadManager::sampleMatrix() {
+    drivePort(KEYPAD_DRIVE_ROWS);
+    uint8_t colBits = ~readPort() & KEYPAD_COL_MASK;
+    idleColumns = colBits;
+    if (colBits == 0) {
+        return 0;
     }
-  
-    // Ensure all rows are set to HIGH before we start scanning
-    for (int i = 0; i < 4; i++) {
-        digitalWrite_I2C(rowPins[i], HIGH);
-    }
-  
-    // Add a small delay to let signals stabilize
-    delayMicroseconds(500);
-  
-    // Scan rows
+    
+    writePort(KEYPAD_DRIVE_COLS);
+    uint8_t rowBits = ~readPort() & KEYPAD_ROW_MASK;
+    writePort(KEYPAD_DRIVE_ROWS);
+    
+    int rowCount = 0;
+    int row = 0;
     for (int r = 0; r < 4; r++) {
-        // Set current row to LOW
-        digitalWrite_I2C(rowPins[r], LOW);
+        if (rowBits & (1 << rowPins[r])) {
+            row = r;
+            rowCount++;
+        }
+    }
     
-        // Add a small delay to let the signal stabilize
-        delayMicroseconds(500);
+    // Several rows active: only a per-row read tells which columns belong
+    // to which row, so walk just the active rows
+    if (rowCount > 1) {
+        return scanRows(rowBits);
+    }
     
-        // Check each column
+    uint16_t mask = 0;
+    for (int c = 0; c < 3; c++) {
+        if (colBits & (1 << colPins[c])) {
+            mask |= 1 << (row * 3 + c);
+        }
+    }
+    return (rowCount == 1) ? mask : 0;
+}
+
+uint16_t KeypadManager::scanRows(uint8_t rowBits) {
+    uint16_t mask = 0;
+    for (int r = 0; r < 4; r++) {
+        if (!(rowBits & (1 << rowPins[r]))) continue;
+        
+        writePort(0xFF & ~(1 << rowPins[r]));
+        uint8_t colBits = ~readPort() & KEYPAD_COL_MASK;
         for (int c = 0; c < 3; c++) {
-            // If a key is pressed, column will read LOW
-            uint8_t colState = digitalRead_I2C(colPins[c]);
-            if (colState == LOW) {
-                // Better debounce
-                delay(20);
-            
-                // Read multiple times to confirm
-                int readCount = 0;
-                for (int i = 0; i < 5; i++) {
-                    if (digitalRead_I2C(colPins[c]) == LOW) {
-                        readCount++;
-                    }
-                    delay(1);
-                }
-            
-                
-                // Only register if most readings were LOW
-                if (readCount >= 3) {
-                    key = keypadLayout[r][c];
-
-                    unsigned long keyPressStartTime = millis();
-                    while (digitalRead_I2C(colPins[c]) == LOW) {
-                        delay(10);
-                        // Add timeout to prevent infinite loop
-                        if (millis() - keyPressStartTime > 3000) {
-                            
-                            break;
-                        }
-                    }
-
-                }
+            if (colBits & (1 << colPins[c])) {
+                mask |= 1 << (r * 3 + c);
             }
         }
-    
-        // Set current row back to HIGH
-        digitalWrite_I2C(rowPins[r], HIGH);
-        if (debugThisScan) {
+    }
+    writePort(KEYPAD_DRIVE_ROWS);
+    return mask;
+}
 
+// Feed one sample to the debouncer and queue an event for every key that
+// toggled. Events are stamped with the sample where the key's raw state first
+// left its debounced state. A sample back at the debounced state, which also
+// restarts the debounce count, drops that stamp.
+char KeypadManager::applySample(uint16_t sample, unsigned long now) {
+    uint16_t deviating = sample ^ debouncer.getState();
+    uint16_t started = deviating & ~edgePending;
+    edgePending = deviating;
+    for (uint8_t bit = 0; started; bit++, started >>= 1) {
+        if (started & 1) {
+            rawEdge[bit] = now;
         }
+    }
     
-        // If a key was pressed, break out of the loop
-        if (key != 0) {
-            break;
+    uint16_t toggled = debouncer.update(sample);
+    edgePending &= ~toggled;  // Those keys agree with their state again
+    uint16_t state = debouncer.getState();
+    char pressed = 0;
+    
+    for (uint8_t bit = 0; toggled >> bit; bit++) {
+        if (!(toggled & (1 << bit))) continue;
+        
+        char key = keyForBit(bit);
+        if (state & (1 << bit)) {
+            pushEvent(key, KEY_PRESS, rawEdge[bit]);
+            lastKey = key;
+            repeatKey = bit;
+            longPressSent = false;
+            nextRepeat = rawEdge[bit] + KEYPAD_LONG_PRESS_MS;
+            if (pressed == 0) pressed = key;
+        } else {
+            pushEvent(key, KEY_RELEASE, rawEdge[bit]);
+            if (repeatKey == bit) repeatKey = -1;
         }
     }
-
-    // Update last key if a new key was pressed
-    if (key != 0) {
-        lastKey = key;
-    } else if (lastKey != 0) {
-        // Key was released
-
+    
+    if (state == 0) {
         lastKey = 0;
     }
+    return pressed;
+}
+
+// Long press after KEYPAD_LONG_PRESS_MS, then auto-repeat every
+// KEYPAD_REPEAT_MS. Events carry their scheduled time, not the scan time.
+void KeypadManager::updateHeldKey(unsigned long now) {
+    if (repeatKey < 0) return;
     
-    if (debugThisScan && key == 0) {
+    if ((long)(now - nextRepeat) >= 0) {
+        char key = keyForBit(repeatKey);
+        if (!longPressSent) {
+            pushEvent(key, KEY_LONG_PRESS, nextRepeat);
+            longPressSent = true;
+        } else {
+            pushEvent(key, KEY_REPEAT, nextRepeat);
+        }
+        nextRepeat += KEYPAD_REPEAT_MS;
+    }
+}
+
+void KeypadManager::pushEvent(char key, KeyEventType type, unsigned long timestamp) {
+    KeyEvent event;
+    event.key = key;
+    event.type = type;
+    event.timestamp = timestamp;
+    event.id = nextEventId++;
+    if (nextEventId == 0) nextEventId = 1;   // 0 means "no event" to the tracer
+    if (events.push(event)) {
+        TRACE_KEY_CAPTURED(event);
     }
-    
-    return key;
 }
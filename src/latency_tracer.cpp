@@ -0,0 +1,151 @@
+#include "latency_tracer.h"
+
+#if LATENCY_TRACE_ENABLED
+
+#include "text_format.h"
+
+LatencyTracer::Trace LatencyTracer::open[LATENCY_MAX_OPEN];
+LatencyTracer::SampleRing LatencyTracer::samples[LATENCY_MILESTONES];
+uint16_t LatencyTracer::context = 0;
+unsigned long LatencyTracer::timedOut = 0;
+
+static const char* const MILESTONE_NAMES[LATENCY_MILESTONES] = {
+    "press->handled", "press->beep", "press->pixel"
+};
+
+void LatencyTracer::captured(const KeyEvent& event) {
+    if (event.type != KEY_PRESS) return;
+    
+    // Take a free slot, or the oldest one if every slot is busy
+    Trace* slot = &open[0];
+    for (uint8_t i = 0; i < LATENCY_MAX_OPEN; i++) {
+        if (open[i].id == 0) {
+            slot = &open[i];
+            break;
+        }
+        if ((long)(open[i].pressTime - slot->pressTime) < 0) {
+            slot = &open[i];
+        }
+    }
+    
+    memset(slot, 0, sizeof(Trace));
+    slot->id = event.id;
+    slot->pressTime = event.timestamp;
+}
+
+LatencyTracer::Trace* LatencyTracer::find(uint16_t id) {
+    if (id == 0) return nullptr;
+    for (uint8_t i = 0; i < LATENCY_MAX_OPEN; i++) {
+        if (open[i].id == id) return &open[i];
+    }
+    return nullptr;
+}
+
+void LatencyTracer::handled(uint16_t id) {
+    Trace* trace = find(id);
+    if (trace) {
+        mark(*trace, LATENCY_HANDLED, millis());
+    }
+}
+
+void LatencyTracer::soundSent(uint16_t id) {
+    Trace* trace = find(id ? id : context);
+    if (trace) {
+        mark(*trace, LATENCY_BEEP, millis());
+    }
+}
+
+// A widget the press changed was drawn into the frame buffer, see UiScreen
+void LatencyTracer::pixelsDrawn(uint16_t id) {
+    Trace* trace = find(id ? id : context);
+    if (trace) {
+        trace->drawn = true;
+    }
+}
+
+// A flush that changed pixels is the first visible effect of the presses
+// whose widgets it drew. Other flushes (the countdown ticking) say nothing
+// about a press, which then keeps waiting or times out.
+void LatencyTracer::pixelsFlushed() {
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < LATENCY_MAX_OPEN; i++) {
+        Trace& trace = open[i];
+        if (trace.id == 0) continue;
+        if (trace.drawn && (trace.reached & (1 << LATENCY_HANDLED))) {
+            mark(trace, LATENCY_PIXEL, now);
+        } else {
+            retireIfDone(trace, now);
+        }
+    }
+}
+
+void LatencyTracer::mark(Trace& trace, LatencyMilestone milestone, unsigned long now) {
+    if (!(trace.reached & (1 << milestone))) {
+        trace.reached |= 1 << milestone;
+        trace.milestone[milestone] = now;
+        
+        SampleRing& ring = samples[milestone];
+        unsigned long latency = now - trace.pressTime;
+        ring.values[ring.next] = (latency > 0xFFFF) ? 0xFFFF : latency;
+        ring.next = (ring.next + 1) % LATENCY_SAMPLES;
+        if (ring.count < LATENCY_SAMPLES) ring.count++;
+    }
+    retireIfDone(trace, now);
+}
+
+// Free the slot once every milestone was seen, or when it is too old.
+// A press with no sound or nothing to show (e.g. a fifth digit) just times out.
+void LatencyTracer::retireIfDone(Trace& trace, unsigned long now) {
+    bool done = trace.reached == (1 << LATENCY_MILESTONES) - 1;
+    if (!done && now - trace.pressTime > LATENCY_TIMEOUT_MS) {
+        timedOut++;
+        done = true;
+    }
+    if (done) {
+        trace.id = 0;
+    }
+}
+
+uint16_t LatencyTracer::percentile(const SampleRing& ring, uint8_t percent) {
+    if (ring.count == 0) return 0;
+    
+    // Insertion sort of a copy, at most LATENCY_SAMPLES entries
+    uint16_t sorted[LATENCY_SAMPLES];
+    for (uint8_t i = 0; i < ring.count; i++) {
+        uint16_t value = ring.values[i];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > value) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+    
+    uint8_t index = ((uint16_t)(ring.count - 1) * percent + 50) / 100;
+    return sorted[index];
+}
+
+uint16_t LatencyTracer::getPercentile(LatencyMilestone milestone, uint8_t percent) {
+    return percentile(samples[milestone], percent);
+}
+
+void LatencyTracer::reset() {
+    memset(open, 0, sizeof(open));
+    memset(samples, 0, sizeof(samples));
+    context = 0;
+    timedOut = 0;
+}
+
+void LatencyTracer::printReport(Print& out) {
+    char line[64];
+    for (uint8_t m = 0; m < LATENCY_MILESTONES; m++) {
+        const SampleRing& ring = samples[m];
+        FORMAT_TEXT(line, "%-15s n=%-3u p50=%ums p99=%ums", MILESTONE_NAMES[m], ring.count,
+                    percentile(ring, 50), percentile(ring, 99));
+        out.println(line);
+    }
+    out.print("timed out: ");
+    out.println(timedOut);
+}
+
+#endif // LATENCY_TRACE_ENABLED
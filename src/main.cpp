@@ -8,6 +8,10 @@
 #include "settings.h"
 #include "keypad_manager.h"
 #include "voltage_monitor.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "latency_tracer.h"
+#include "hal.h"
 
 
 // Global variables
@@ -23,9 +27,18 @@ Settings settings;
 KeypadManager keypad;
 VoltageMonitor voltage;
 
-// Keep track of last voltage reading time
-unsigned long lastVoltageCheck = 0;
+Scheduler scheduler;
+
+// Task periods (ms) and expected worst-case slices (us)
+const unsigned long KEYPAD_TASK_PERIOD = 5;
+const unsigned long BUTTON_TASK_PERIOD = 2;
+const unsigned long GAME_TASK_PERIOD = 10;
+const unsigned long SOUND_TASK_PERIOD = 2;
 const unsigned long VOLTAGE_CHECK_INTERVAL = 10000;  // Check every 10 seconds
+const unsigned long CONSOLE_TASK_PERIOD = 100;
+const unsigned long SETTINGS_TASK_PERIOD = 1000;
+
+int8_t renderTask = -1;  // On-demand task, requested when the game has something new to show
 
 // Add button state variables
 bool redButtonState = false;
@@ -36,6 +49,15 @@ bool lastGreenButtonState = false;
 
 
 
+void keypadTask();
+void buttonTask();
+void gameTask();
+void soundTask();
+void renderGameTask();
+void voltageTask();
+void consoleTask();
+void settingsTask();
+
 void setup() {
   Serial.begin(115200);
   Serial.println("\nAirsoft Bomb");
@@ -44,7 +66,7 @@ void setup() {
 
   if (!sound.init())
   {  
-    ESP.restart();
+    halRestart();
   }
   // Test OLED display first before anything else
   Serial.println("Testing display initialization...");
@@ -64,6 +86,9 @@ void setup() {
   
   // Initialize managers
   settings.load();
+  if (settings.isStored()) {
+    dominationGame.setDefaultGameTime(settings.getDomTime());  // Last match length played
+  }
   // Skip sound initialization for now
   display.showWelcome();
   
@@ -88,78 +113,180 @@ void setup() {
   Serial.println("Airsoft Bomb System Initialized");
   pinMode(PIN_RED_BUTTON, INPUT_PULLUP);
   pinMode(PIN_GREEN_BUTTON, INPUT_PULLUP);
+  voltage.init();
+  
+  scheduler.addTask("keypad", keypadTask, KEYPAD_TASK_PERIOD, 1000);
+  scheduler.addTask("buttons", buttonTask, BUTTON_TASK_PERIOD, 200);
+  scheduler.addTask("game", gameTask, GAME_TASK_PERIOD, 2000);
+  scheduler.addTask("sound", soundTask, SOUND_TASK_PERIOD, 2500);
+  renderTask = scheduler.addTask("render", renderGameTask, 0, 30000);
+  scheduler.addTask("voltage", voltageTask, VOLTAGE_CHECK_INTERVAL, 1000);
+  scheduler.addTask("console", consoleTask, CONSOLE_TASK_PERIOD, 500);
+  scheduler.addTask("settings", settingsTask, SETTINGS_TASK_PERIOD, 50000);  // A commit erases a flash sector
 }
 
 void loop() {
- 
-  // Handle keypad input - FIXED: Actually call the scanKeypad function
-  char key = keypad.scanKeypad();
-
-  
-  // If a key is pressed from the keypad
-  if (key != 0) {
-    sound.play(SOUND_BEEP);
-    Serial.print("Key pressed: ");
-    Serial.println(key);
-    // Pass the key to the active game
-    activeGame->handleButton(key);
-  }
-  
-  // Read team buttons for domination mode
-  if (currentMode == DOMINATION_MODE) {
-    redButtonState = !digitalRead(PIN_RED_BUTTON);    // Inverted because of pull-up
-    greenButtonState = !digitalRead(PIN_GREEN_BUTTON); // Inverted because of pull-up
-    
-    // Track button state changes for domination game
-    DominationMode* domGame = (DominationMode*)activeGame;
-    
-    // Debug prints for button states
-    static bool printedLastState = false;
-    if (redButtonState || greenButtonState) {
-      if (!printedLastState) {
-        Serial.print("Button held - Red: ");
-        Serial.print(redButtonState);
-        Serial.print(", Green: ");
-        Serial.println(greenButtonState);
-        printedLastState = true;
-      }
-    } else {
-      printedLastState = false;
-    }
-    
-    // Check for red button press
-    if (redButtonState && !lastRedButtonState) {
-      Serial.println("Red button pressed");
-      domGame->handleButton('R');
-    }
-    
-    // Check for red button release
-    if (!redButtonState && lastRedButtonState) {
-      Serial.println("Red button released");
-      domGame->handleButton('r');  // Lowercase 'r' for release
-    }
-    
-    // Check for green button press
-    if (greenButtonState && !lastGreenButtonState) {
-      Serial.println("Green button pressed");
-      domGame->handleButton('G');
-    }
-    
-    // Check for green button release
-    if (!greenButtonState && lastGreenButtonState) {
-      Serial.println("Green button released");
-      domGame->handleButton('g');  // Lowercase 'g' for release
+  // Run whatever is due, then sleep until the next task deadline
+  scheduler.run();
+}
+
+// Scan the keypad and hand the queued key events to the game
+void keypadTask() {
+  // Handle keypad input - the scanner queues timestamped key events
+  {
+    PROFILE_SCOPE(PROBE_KEYPAD_SCAN);
+    keypad.scanKeypad();
+  }
+  KeyEventQueue& keyEvents = keypad.getEvents();
+  
+  // Beep for every key pressed from the keypad
+  for (uint8_t i = 0; i < keyEvents.count(); i++) {
+    const KeyEvent& event = keyEvents.peek(i);
+    if (event.type == KEY_PRESS) {
+      TRACE_CONTEXT(event.id);
+      sound.play(SOUND_BEEP);
+      TRACE_CONTEXT_END();
+      Serial.print("Key pressed: ");
+      Serial.println(event.key);
     }
-    domGame->updateButtonStates(redButtonState, greenButtonState);
-    
-    lastRedButtonState = redButtonState;
-    lastGreenButtonState = greenButtonState;
   }
   
+  // Pass the whole batch to the active game
+  activeGame->processKeyEvents(keyEvents);
+}
 
+// Read team buttons for domination mode
+void buttonTask() {
+  if (currentMode != DOMINATION_MODE) return;
+  PROFILE_SCOPE(PROBE_BUTTONS);
+  
+  redButtonState = !digitalRead(PIN_RED_BUTTON);    // Inverted because of pull-up
+  greenButtonState = !digitalRead(PIN_GREEN_BUTTON); // Inverted because of pull-up
   
-  // Update the active game state
+  // Track button state changes for domination game
+  DominationMode* domGame = (DominationMode*)activeGame;
+  
+  // Debug prints for button states
+  static bool printedLastState = false;
+  if (redButtonState || greenButtonState) {
+    if (!printedLastState) {
+      Serial.print("Button held - Red: ");
+      Serial.print(redButtonState);
+      Serial.print(", Green: ");
+      Serial.println(greenButtonState);
+      printedLastState = true;
+    }
+  } else {
+    printedLastState = false;
+  }
+  
+  // Check for red button press
+  if (redButtonState && !lastRedButtonState) {
+    Serial.println("Red button pressed");
+    domGame->handleButton('R');
+  }
+  
+  // Check for red button release
+  if (!redButtonState && lastRedButtonState) {
+    Serial.println("Red button released");
+    domGame->handleButton('r');  // Lowercase 'r' for release
+  }
+  
+  // Check for green button press
+  if (greenButtonState && !lastGreenButtonState) {
+    Serial.println("Green button pressed");
+    domGame->handleButton('G');
+  }
+  
+  // Check for green button release
+  if (!greenButtonState && lastGreenButtonState) {
+    Serial.println("Green button released");
+    domGame->handleButton('g');  // Lowercase 'g' for release
+  }
+  domGame->updateButtonStates(redButtonState, greenButtonState);
+  
+  lastRedButtonState = redButtonState;
+  lastGreenButtonState = greenButtonState;
+}
+
+// Advance the game; ask for a frame only when a widget changed
+void gameTask() {
+  PROFILE_SCOPE(PROBE_GAME_UPDATE);
+  activeGame->tick();
+  if (activeGame->needsRender()) {
+    scheduler.request(renderTask);
+  }
+}
+
+// Send queued DFPlayer commands, a couple of bytes at a time
+void soundTask() {
+  sound.update();
+}
 
-  activeGame->update();
-  delay(10); // Small delay to prevent CPU hogging
-}
\ No newline at end of file
+void renderGameTask() {
+  PROFILE_SCOPE(PROBE_RENDER);
+  activeGame->render();
+}
+
+void voltageTask() {
+  PROFILE_SCOPE(PROBE_VOLTAGE);
+  float volts = voltage.readVoltage();
+  Serial.print("Battery: ");
+  Serial.print(volts);
+  Serial.println("V");
+}
+
+// Keep what the players chose. The setup presses only change the game; the
+// match length is copied once the match runs, and save() commits only when
+// something differs, so a whole setup costs at most one flash write.
+void settingsTask() {
+  settings.setGameMode(currentMode);
+  if (currentMode == DOMINATION_MODE && dominationGame.state == RUNNING) {
+    settings.setDomTime(dominationGame.getGameTime());
+  }
+  if (settings.save()) {
+    Serial.println("Settings saved");
+  }
+}
+
+// Single-character diagnostic commands on the serial monitor
+//   p - profiler report, s - scheduler task stats, l - key latency report,
+//   a - sound module and arbiter counters, r - reset all
+void consoleTask() {
+  while (Serial.available() > 0) {
+    char command = Serial.read();
+    switch (command) {
+      case 'p':
+#if PROFILER_ENABLED
+        Profiler::printReport(Serial);
+#else
+        Serial.println("Profiler disabled (PROFILER_ENABLED in config.h)");
+#endif
+        break;
+      case 's':
+        scheduler.printStats(Serial);
+        break;
+      case 'l':
+#if LATENCY_TRACE_ENABLED
+        LatencyTracer::printReport(Serial);
+#else
+        Serial.println("Latency tracing disabled (LATENCY_TRACE_ENABLED in config.h)");
+#endif
+        break;
+      case 'a':
+        sound.printStats(Serial);
+        break;
+      case 'r':
+#if PROFILER_ENABLED
+        Profiler::reset();
+#endif
+#if LATENCY_TRACE_ENABLED
+        LatencyTracer::reset();
+#endif
+        scheduler.resetStats();
+        sound.resetStats();
+        Serial.println("Stats reset");
+        break;
+    }
+  }
+}
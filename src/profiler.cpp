@@ -0,0 +1,64 @@
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+#include "text_format.h"
+
+static const char* const PROBE_NAMES[PROBE_COUNT] = {
+    "pass", "keypad", "buttons", "game", "render", "flush", "sound", "sound_tx", "voltage"
+};
+
+ProbeStats Profiler::probes[PROBE_COUNT];
+
+void Profiler::record(ProfileProbe probe, uint32_t cycles) {
+    ProbeStats& stats = probes[probe];
+    if (stats.count == 0 || cycles < stats.minCycles) {
+        stats.minCycles = cycles;
+    }
+    if (cycles > stats.maxCycles) {
+        stats.maxCycles = cycles;
+    }
+    stats.count++;
+    stats.totalCycles += cycles;
+    
+    // Bucket by the position of the highest set bit
+    int log2 = (cycles == 0) ? 0 : 31 - __builtin_clz(cycles);
+    int bucket = constrain(log2 - PROFILER_FIRST_BUCKET_LOG2, 0, PROFILER_BUCKETS - 1);
+    if (stats.histogram[bucket] < 0xFFFF) {
+        stats.histogram[bucket]++;
+    }
+}
+
+void Profiler::reset() {
+    memset(probes, 0, sizeof(probes));
+}
+
+void Profiler::printReport(Print& out) {
+    uint32_t cyclesPerMicro = halCpuMHz();
+    char line[96];
+    
+    out.println("probe        count   min_us  mean_us   max_us");
+    for (uint8_t i = 0; i < PROBE_COUNT; i++) {
+        const ProbeStats& stats = probes[i];
+        if (stats.count == 0) continue;
+        
+        FORMAT_TEXT(line, "%-9s %8lu %8lu %8lu %8lu", PROBE_NAMES[i],
+                    (unsigned long)stats.count,
+                    (unsigned long)(stats.minCycles / cyclesPerMicro),
+                    (unsigned long)(stats.totalCycles / stats.count / cyclesPerMicro),
+                    (unsigned long)(stats.maxCycles / cyclesPerMicro));
+        out.println(line);
+        
+        // Histogram: one count per log2 bucket, labelled with its lower bound in us
+        out.print("  hist");
+        for (uint8_t b = 0; b < PROFILER_BUCKETS; b++) {
+            if (stats.histogram[b] == 0) continue;
+            uint32_t lowerCycles = (b == 0) ? 0 : (1UL << (b + PROFILER_FIRST_BUCKET_LOG2));
+            FORMAT_TEXT(line, " %lu+us:%u", (unsigned long)(lowerCycles / cyclesPerMicro), stats.histogram[b]);
+            out.print(line);
+        }
+        out.println();
+    }
+}
+
+#endif // PROFILER_ENABLED
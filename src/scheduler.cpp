@@ -0,0 +1,123 @@
+#include "scheduler.h"
+#include "text_format.h"
+#include "profiler.h"
+
+Scheduler::Scheduler() : taskCount(0), idleMillis(0) {}
+
+int8_t Scheduler::addTask(const char* name, TaskFunction function, unsigned long periodMs, unsigned long budgetMicros) {
+    if (taskCount >= SCHEDULER_MAX_TASKS) {
+        return -1;
+    }
+    
+    ScheduledTask& task = tasks[taskCount];
+    memset(&task, 0, sizeof(task));
+    task.name = name;
+    task.function = function;
+    task.period = periodMs;
+    task.budgetMicros = budgetMicros;
+    task.nextRun = millis();
+    return taskCount++;
+}
+
+void Scheduler::request(int8_t id) {
+    if (id >= 0 && id < taskCount) {
+        tasks[id].requested = true;
+    }
+}
+
+void Scheduler::run() {
+    {
+        PROFILE_SCOPE(PROBE_SCHEDULER_PASS);
+        for (uint8_t i = 0; i < taskCount; i++) {
+            ScheduledTask& task = tasks[i];
+            unsigned long now = millis();
+            bool due = task.period > 0 && (long)(now - task.nextRun) >= 0;
+            
+            if (due || task.requested) {
+                runTask(task, now);
+            }
+        }
+    }
+    
+    unsigned long wait = millisUntilNextRun(millis());
+    if (wait > 0) {
+        idleMillis += wait;
+        delay(wait);
+    } else {
+        yield();
+    }
+}
+
+void Scheduler::runTask(ScheduledTask& task, unsigned long now) {
+    task.requested = false;
+    
+    if (task.period > 0 && (long)(now - task.nextRun) >= 0) {
+        // Keep the cadence fixed to the original deadlines; if we fell more
+        // than a whole period behind, skip the missed slots instead of
+        // running the task back to back
+        task.nextRun += task.period;
+        if ((long)(now - task.nextRun) >= 0) {
+            task.missed += (now - task.nextRun) / task.period + 1;
+            task.nextRun = now + task.period;
+        }
+    }
+    
+    unsigned long start = micros();
+    task.function();
+    unsigned long elapsed = micros() - start;
+    
+    task.runs++;
+    task.totalMicros += elapsed;
+    if (elapsed > task.maxMicros) {
+        task.maxMicros = elapsed;
+    }
+    if (elapsed > task.budgetMicros) {
+        task.overruns++;
+    }
+}
+
+unsigned long Scheduler::millisUntilNextRun(unsigned long now) const {
+    unsigned long wait = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const ScheduledTask& task = tasks[i];
+        if (task.requested) {
+            return 0;
+        }
+        if (task.period == 0) {
+            continue;
+        }
+        if ((long)(task.nextRun - now) <= 0) {
+            return 0;
+        }
+        if (task.nextRun - now < wait) {
+            wait = task.nextRun - now;
+        }
+    }
+    return (wait == 0xFFFFFFFF) ? 0 : wait;
+}
+
+void Scheduler::resetStats() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        tasks[i].runs = 0;
+        tasks[i].totalMicros = 0;
+        tasks[i].maxMicros = 0;
+        tasks[i].overruns = 0;
+        tasks[i].missed = 0;
+    }
+    idleMillis = 0;
+}
+
+void Scheduler::printStats(Print& out) const {
+    out.println("task        runs   avg_us   max_us  budget  over  missed");
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const ScheduledTask& task = tasks[i];
+        char line[80];
+        FORMAT_TEXT(line, "%-10s %6lu %8lu %8lu %7lu %5lu %7lu",
+                 task.name, task.runs,
+                 task.runs ? task.totalMicros / task.runs : 0UL,
+                 task.maxMicros, task.budgetMicros, task.overruns, task.missed);
+        out.println(line);
+    }
+    out.print("idle ms: ");
+    out.println(idleMillis);
+}
@@ -2,123 +2,166 @@
 #include <EEPROM.h>
 #include <Arduino.h>
 
-Settings::Settings() {
+Settings::Settings()
+    : gameMode(DEFUSE_MODE), defuseTime(0), domTime(0), codeLength(0), code(""),
+      opened(false), dirty(false), currentSlot(-1), sequence(0) {
     // Set default values
     reset();
+    dirty = false;
+}
+
+// The ESP8266 EEPROM is a RAM copy of one flash sector that only exists
+// after begin()
+void Settings::open() {
+    if (!opened) {
+        EEPROM.begin(SETTINGS_EEPROM_SIZE);
+        opened = true;
+    }
+}
+
+int Settings::slotAddress(uint8_t slot) {
+    return EEPROM_SETTINGS_START + slot * sizeof(SettingsRecord);
+}
+
+// CRC-16/CCITT (poly 0x1021, init 0xFFFF)
+uint16_t Settings::crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Erased flash, the old unversioned layout and records that did not read
+// back as written all fail here
+bool Settings::isValid(const SettingsRecord& record) {
+    return record.magic == SETTINGS_MAGIC && record.version == SETTINGS_VERSION &&
+           record.crc == crc16((const uint8_t*)&record, offsetof(SettingsRecord, crc));
 }
 
 void Settings::load() {
-    // Read game mode
-    gameMode = EEPROM.read(EEPROM_SETTINGS_START);
-    
-    // Validate game mode
-    if (gameMode > DOMINATION_MODE) {
-        gameMode = DEFUSE_MODE;
+    open();
+
+    // One pass over the slots: the newest valid record wins. Sequence
+    // numbers are compared as a difference so they can wrap.
+    SettingsRecord newest;
+    currentSlot = -1;
+    for (uint8_t slot = 0; slot < SETTINGS_SLOT_COUNT; slot++) {
+        SettingsRecord record;
+        EEPROM.get(slotAddress(slot), record);
+        if (!isValid(record)) continue;
+        if (currentSlot < 0 || (int16_t)(record.sequence - newest.sequence) > 0) {
+            newest = record;
+            currentSlot = slot;
+        }
     }
-    
-    // Read defuse time
-    defuseTime = readInt(EEPROM_SETTINGS_START + 1);
-    
-    // Validate defuse time
-    if (defuseTime < 60 || defuseTime > 3600) {
-        defuseTime = DEFAULT_DEFUSE_TIME_MINUTES * 60;
+
+    reset();
+    if (currentSlot >= 0) {
+        sequence = newest.sequence;
+        apply(newest);
+    } else {
+        sequence = 0;
+    }
+    dirty = false;
+}
+
+// Values still go through the range checks, a valid CRC only says the
+// record is the one that was written
+void Settings::apply(const SettingsRecord& record) {
+    if (record.gameMode <= DOMINATION_MODE) {
+        gameMode = record.gameMode;
     }
-    
-    // Read domination time
-    domTime = readInt(EEPROM_SETTINGS_START + 3);
-    
-    // Validate domination time
-    if (domTime < 60 || domTime > 3600) {
-        domTime = DEFAULT_DOM_TIME_MINUTES * 60;
+    if (record.defuseTime >= 60 && record.defuseTime <= 3600) {
+        defuseTime = record.defuseTime;
     }
-    
-    // Read code length
-    codeLength = EEPROM.read(EEPROM_SETTINGS_START + 5);
-    
-    // Validate code length
-    if (codeLength < 1 || codeLength > 7) {
-        codeLength = DEFAULT_CODE_LENGTH;
+    if (record.domTime >= 60 && record.domTime <= 3600) {
+        domTime = record.domTime;
     }
-    
-    // Read code
-    for (int i = 0; i < codeLength; i++) {
-        code[i] = EEPROM.read(EEPROM_SETTINGS_START + 6 + i);
-        
-        // Validate char is a digit
-        if (code[i] < '0' || code[i] > '9') {
-            code[i] = '0';
+    if (record.codeLength >= 1 && record.codeLength <= 7) {
+        codeLength = record.codeLength;
+        for (int i = 0; i < codeLength; i++) {
+            // Validate char is a digit
+            code[i] = (record.code[i] >= '0' && record.code[i] <= '9') ? record.code[i] : '0';
         }
+        code[codeLength] = '\0';
     }
-    
-    // Null terminate
-    code[codeLength] = '\0';
 }
 
-void Settings::save() {
-    // Write game mode
-    EEPROM.write(EEPROM_SETTINGS_START, gameMode);
-    
-    // Write defuse time
-    writeInt(EEPROM_SETTINGS_START + 1, defuseTime);
-    
-    // Write domination time
-    writeInt(EEPROM_SETTINGS_START + 3, domTime);
-    
-    // Write code length
-    EEPROM.write(EEPROM_SETTINGS_START + 5, codeLength);
-    
-    // Write code
-    for (int i = 0; i < codeLength; i++) {
-        EEPROM.write(EEPROM_SETTINGS_START + 6 + i, code[i]);
-    }
-}
+// Writes a record to the slot after the current one, keeping the previous
+// record in the sector, then commits once. The commit erases and rewrites
+// the whole sector. Nothing is written when no field changed.
+bool Settings::save() {
+    if (!dirty) return false;
+    open();
 
-void Settings::reset() {
-    gameMode = DEFUSE_MODE;
-    defuseTime = DEFAULT_DEFUSE_TIME_MINUTES * 60; // Convert minutes to seconds
-    domTime = DEFAULT_DOM_TIME_MINUTES * 60;       // Convert minutes to seconds  
-    codeLength = DEFAULT_CODE_LENGTH;
-    strcpy(code, "1234");  // Default code
-}
+    SettingsRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = SETTINGS_MAGIC;
+    record.version = SETTINGS_VERSION;
+    record.sequence = sequence + 1;
+    record.gameMode = gameMode;
+    record.codeLength = codeLength;
+    record.defuseTime = defuseTime;
+    record.domTime = domTime;
+    memcpy(record.code, code, codeLength);  // Rest stays zero
+    record.crc = crc16((const uint8_t*)&record, offsetof(SettingsRecord, crc));
 
-void Settings::writeInt(int addr, int value) {
-    EEPROM.write(addr, value & 0xFF);
-    EEPROM.write(addr + 1, (value >> 8) & 0xFF);
+    uint8_t slot = (currentSlot + 1) % SETTINGS_SLOT_COUNT;
+    EEPROM.put(slotAddress(slot), record);
+    if (!EEPROM.commit()) {
+        return false;
+    }
+    currentSlot = slot;
+    sequence = record.sequence;
+    dirty = false;
+    return true;
 }
 
-int Settings::readInt(int addr) {
-    return EEPROM.read(addr) | (EEPROM.read(addr + 1) << 8);
+void Settings::reset() {
+    setGameMode(DEFUSE_MODE);
+    setDefuseTime(DEFAULT_DEFUSE_TIME_MINUTES * 60); // Convert minutes to seconds
+    setDomTime(DEFAULT_DOM_TIME_MINUTES * 60);       // Convert minutes to seconds
+    setCode("1234");  // Default code, DEFAULT_CODE_LENGTH digits
 }
 
 void Settings::setGameMode(byte mode) {
-    if (mode <= DOMINATION_MODE) {
+    if (mode <= DOMINATION_MODE && mode != gameMode) {
         gameMode = mode;
+        dirty = true;
     }
 }
 
 void Settings::setDefuseTime(int seconds) {
-    if (seconds >= 60 && seconds <= 3600) {
+    if (seconds >= 60 && seconds <= 3600 && seconds != defuseTime) {
         defuseTime = seconds;
+        dirty = true;
     }
 }
 
 void Settings::setDomTime(int score) {
-    if (score >= 60 && score <= 3600) {
+    if (score >= 60 && score <= 3600 && score != domTime) {
         domTime = score;
+        dirty = true;
     }
 }
 
 void Settings::setCodeLength(byte length) {
-    if (length >= 1 && length <= 7) {
+    if (length >= 1 && length <= 7 && length != codeLength) {
         codeLength = length;
+        dirty = true;
     }
 }
 
 void Settings::setCode(const char* newCode) {
     size_t len = strlen(newCode);
-    if (len > 0 && len <= 7) {
+    if (len > 0 && len <= 7 && (len != codeLength || strncmp(code, newCode, len) != 0)) {
         strncpy(code, newCode, 7);
         code[len] = '\0';
         codeLength = len;
+        dirty = true;
     }
-}
\ No newline at end of file
+}
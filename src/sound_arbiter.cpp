@@ -0,0 +1,138 @@
+#include "sound_arbiter.h"
+#include "text_format.h"
+
+// Indexed by SoundType. Game results outrank everything and are heard to
+// the end, key feedback is the first to go. Minimum durations are roughly
+// how long the cue must be heard to make sense, not the length of the track.
+static const SoundProfile PROFILES[SOUND_WARNING + 1] = {
+    {1, 200, 100, false, false},   // 0, unused
+    {2, 1000, 500, true, false},   // SOUND_PLANTED
+    {3, 2000, 1000, false, true},  // SOUND_DEFUSED
+    {1, 150, 200, false, false},   // SOUND_TIME
+    {0, 80, 60, false, false},     // SOUND_BEEP
+    {2, 1000, 500, true, false},   // SOUND_GAME_START
+    {3, 3000, 1000, false, true},  // SOUND_EXPLOSION
+    {0, 80, 60, false, false},     // SOUND_BUTTON_PRESS
+    {1, 300, 300, true, false},    // SOUND_ERROR
+    {2, 500, 500, true, false},    // SOUND_WARNING
+};
+
+SoundArbiter::SoundArbiter() : current(0), currentStart(0), pending(0), pendingSince(0), startedMask(0) {
+    memset(lastStart, 0, sizeof(lastStart));
+    memset(&undo, 0, sizeof(undo));
+    resetStats();
+}
+
+const SoundProfile& SoundArbiter::profile(uint8_t sound) {
+    return PROFILES[sound <= SOUND_WARNING ? sound : 0];
+}
+
+// A holdToEnd cue lasts until trackEnded() or stopped(); the cap is for a
+// module that never reports (RX not wired, reply lost)
+bool SoundArbiter::protects(unsigned long now) const {
+    if (current == 0) return false;
+    const SoundProfile& playing = profile(current);
+    unsigned long age = now - currentStart;
+    return age < playing.minDurationMs || (playing.holdToEnd && age < SOUND_HOLD_MAX_MS);
+}
+
+void SoundArbiter::start(uint8_t sound, unsigned long now) {
+    undo.sound = sound;
+    undo.current = current;
+    undo.currentStart = currentStart;
+    undo.lastStart = (sound <= SOUND_WARNING) ? lastStart[sound] : 0;
+    undo.startedMask = startedMask;
+    undo.preempted = false;
+
+    current = sound;
+    currentStart = now;
+    if (sound <= SOUND_WARNING) {
+        lastStart[sound] = now;
+        startedMask |= 1 << sound;
+    }
+    stats.played++;
+}
+
+bool SoundArbiter::request(uint8_t sound, unsigned long now) {
+    const SoundProfile& wanted = profile(sound);
+
+    // The same sound just started: one play covers both requests
+    if (sound <= SOUND_WARNING && (startedMask & (1 << sound)) &&
+        now - lastStart[sound] < wanted.coalesceMs) {
+        stats.coalesced++;
+        return false;
+    }
+
+    bool preempting = false;
+    if (protects(now)) {
+        uint8_t playing = profile(current).priority;
+        if (wanted.priority > playing) {
+            stats.preempted++;
+            preempting = true;
+        } else if (wanted.deferrable) {
+            // One cue waits at most: the more important, else the newer
+            if (pending != 0) {
+                stats.dropped++;
+                if (profile(pending).priority > wanted.priority) return false;
+            }
+            pending = sound;
+            pendingSince = now;
+            stats.deferred++;
+            return false;
+        } else {
+            stats.dropped++;
+            return false;
+        }
+    }
+
+    start(sound, now);
+    undo.preempted = preempting;
+    return true;
+}
+
+uint8_t SoundArbiter::poll(unsigned long now) {
+    if (pending == 0 || protects(now)) return 0;
+    uint8_t sound = pending;
+    pending = 0;
+    if (now - pendingSince > SOUND_DEFER_MAX_MS) {
+        stats.expired++;
+        return 0;
+    }
+    start(sound, now);
+    return sound;
+}
+
+void SoundArbiter::stopped() {
+    current = 0;
+    pending = 0;
+}
+
+// Nothing is left to protect; unlike stopped(), the deferred cue is kept.
+// The end of an older track (reported while ours was still queued) is ignored.
+void SoundArbiter::trackEnded(uint16_t track) {
+    if (track == current) {
+        current = 0;
+    }
+}
+
+// The play command could not be queued: back to the state before start(),
+// so later requests are neither merged with nor blocked by a silent cue
+void SoundArbiter::notStarted() {
+    current = undo.current;
+    currentStart = undo.currentStart;
+    if (undo.sound <= SOUND_WARNING) lastStart[undo.sound] = undo.lastStart;
+    startedMask = undo.startedMask;
+    stats.played--;
+    if (undo.preempted) stats.preempted--;
+}
+
+void SoundArbiter::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void SoundArbiter::printStats(Print& out) const {
+    char line[112];
+    FORMAT_TEXT(line, "sound played %lu coalesced %lu dropped %lu deferred %lu preempted %lu expired %lu",
+                stats.played, stats.coalesced, stats.dropped, stats.deferred, stats.preempted, stats.expired);
+    out.println(line);
+}
@@ -1,8 +1,31 @@
 #include "sound_manager.h"
 #include <Arduino.h>
+#include "profiler.h"
+#include "latency_tracer.h"
+#include "text_format.h"
+
+// DFPlayer commands used at run time
+#define DFPLAYER_CMD_PLAY 0x03
+#define DFPLAYER_CMD_VOLUME 0x06
+#define DFPLAYER_CMD_STOP 0x16
+
+// Reports the module sends on its own, or as replies to queries
+#define DFPLAYER_CARD_REMOVED 0x3B
+#define DFPLAYER_USB_FINISHED 0x3C
+#define DFPLAYER_SD_FINISHED 0x3D
+#define DFPLAYER_CARD_ONLINE 0x3F
+#define DFPLAYER_ERROR 0x40
+#define DFPLAYER_STATUS 0x42
+#define DFPLAYER_VOLUME 0x43
 
 // Use the renamed pins from config.h
-SoundManager::SoundManager() : dfPlayerSerial(5, 4), initialized(false), volume(20) {}
+SoundManager::SoundManager()
+    : dfPlayerSerial(5, 4), initialized(false), volume(20), moduleVolume(0xFF),
+      queueHead(0), queueTail(0), dropped(0),
+      framePosition(DFPLAYER_FRAME_SIZE), frameTraceId(0), lastFrameTime(0),
+      rxPosition(0), playing(false), playingTrack(0), onTrackFinished(nullptr) {
+    resetStats();
+}
 
 bool SoundManager::init() {
     delay(2000);
@@ -16,34 +39,196 @@ bool SoundManager::init() {
         Serial.println("DFPlayer online!");
         initialized = true;
         dfPlayer.volume(volume);
+        moduleVolume = volume;
         delay(100);
+        lastFrameTime = millis();
         return true;
     }
 }
 
+// Returns in microseconds: the frame is built and sent later by update().
+// A full queue drops the new command, the ones already waiting go first.
+bool SoundManager::enqueue(uint8_t command, uint16_t parameter) {
+    if (!initialized) return false;
+    uint8_t next = (queueHead + 1) & (SOUND_QUEUE_SIZE - 1);
+    if (next == queueTail) {
+        dropped++;
+        return false;
+    }
+    queue[queueHead] = {command, parameter, TRACE_CURRENT_CONTEXT()};
+    queueHead = next;
+    return true;
+}
+
+// The module keeps the last volume it was sent, so only a change costs a
+// command. Tracked at queue time: commands go out in order.
+void SoundManager::queueVolume(uint8_t vol) {
+    if (vol == moduleVolume) return;
+    if (enqueue(DFPLAYER_CMD_VOLUME, vol)) {
+        moduleVolume = vol;
+    }
+}
+
+void SoundManager::startFrame(const SoundCommand& command) {
+    // No ACK requested: nothing would wait for it, and the module then sends
+    // nothing back unless asked
+    frame[0] = 0x7E;
+    frame[1] = 0xFF;
+    frame[2] = 0x06;
+    frame[3] = command.command;
+    frame[4] = 0x00;
+    frame[5] = command.parameter >> 8;
+    frame[6] = command.parameter & 0xFF;
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < 7; i++) sum += frame[i];
+    sum = 0 - sum;
+    frame[7] = sum >> 8;
+    frame[8] = sum & 0xFF;
+    frame[9] = 0xEF;
+    framePosition = 0;
+    frameTraceId = command.traceId;
+}
+
+// Called from the sound task. SoftwareSerial bit-bangs every byte with the
+// CPU waiting (~1 ms at 9600 baud), so at most SOUND_TX_BYTES_PER_TICK go
+// out per call, and a new frame only starts SOUND_COMMAND_GAP_MS after the
+// previous one was complete.
+void SoundManager::update() {
+    if (!initialized) return;
+
+    while (dfPlayerSerial.available()) {
+        receive(dfPlayerSerial.read());
+    }
+
+    // A cue held back by the arbiter may go now
+    uint8_t deferred = arbiter.poll(millis());
+    if (deferred) {
+        startTrack(deferred);
+    }
+
+    if (framePosition == DFPLAYER_FRAME_SIZE) {
+        if (queueHead == queueTail) return;
+        if (millis() - lastFrameTime < SOUND_COMMAND_GAP_MS) return;
+        startFrame(queue[queueTail]);
+        queueTail = (queueTail + 1) & (SOUND_QUEUE_SIZE - 1);
+    }
+
+    PROFILE_SCOPE(PROBE_SOUND_TX);
+    for (uint8_t n = 0; n < SOUND_TX_BYTES_PER_TICK && framePosition < DFPLAYER_FRAME_SIZE; n++) {
+        dfPlayerSerial.write(frame[framePosition++]);
+    }
+    if (framePosition == DFPLAYER_FRAME_SIZE) {
+        frameSent();
+    }
+}
+
+void SoundManager::frameSent() {
+    lastFrameTime = millis();
+    TRACE_SOUND_SENT(frameTraceId);
+    if (frame[3] == DFPLAYER_CMD_PLAY) {
+        playing = true;
+        playingTrack = ((uint16_t)frame[5] << 8) | frame[6];
+    } else if (frame[3] == DFPLAYER_CMD_STOP) {
+        playing = false;
+    }
+}
+
+// Collects reply frames byte by byte. Anything that does not start with 0x7E
+// is noise between frames; a frame that fails its checks is dropped whole.
+void SoundManager::receive(uint8_t c) {
+    if (rxPosition == 0 && c != 0x7E) return;
+    rxFrame[rxPosition++] = c;
+    if (rxPosition < DFPLAYER_FRAME_SIZE) return;
+    rxPosition = 0;
+
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < 7; i++) sum += rxFrame[i];
+    uint16_t checksum = ((uint16_t)rxFrame[7] << 8) | rxFrame[8];
+    if (rxFrame[1] != 0xFF || rxFrame[2] != 0x06 || rxFrame[9] != 0xEF ||
+        (uint16_t)(sum + checksum) != 0) {
+        rxBadFrames++;
+        return;
+    }
+    handleReply(rxFrame[3], ((uint16_t)rxFrame[5] << 8) | rxFrame[6]);
+}
+
+void SoundManager::handleReply(uint8_t command, uint16_t parameter) {
+    switch (command) {
+        case DFPLAYER_SD_FINISHED:
+        case DFPLAYER_USB_FINISHED:
+            // The module tends to report the same end twice
+            if (!playing) break;
+            tracksFinished++;
+            lastFinishedTrack = parameter;
+            trackEnded(parameter);
+            if (onTrackFinished) onTrackFinished(parameter);
+            break;
+        case DFPLAYER_ERROR:
+            // Busy, bad checksum, missing track...: whatever was asked is not playing
+            moduleErrors++;
+            lastError = parameter & 0xFF;
+            if (playing) trackEnded(playingTrack);
+            break;
+        case DFPLAYER_CARD_ONLINE:
+            // The module restarted and lost its volume
+            moduleVolume = 0xFF;
+            if (playing) trackEnded(playingTrack);
+            break;
+        case DFPLAYER_CARD_REMOVED:
+            if (playing) trackEnded(playingTrack);
+            break;
+        case DFPLAYER_STATUS:
+            // Low byte 1 = playing; only ever an answer to someone else's query
+            if (playing && (parameter & 0xFF) != 1) trackEnded(playingTrack);
+            break;
+        case DFPLAYER_VOLUME:
+            moduleVolume = parameter & 0xFF;
+            break;
+    }
+}
+
+void SoundManager::trackEnded(uint16_t track) {
+    playing = false;
+    arbiter.trackEnded(track);
+}
+
+// Queue a play command. Plays still waiting in the queue are dropped: the
+// module would cut them off the moment this one arrives. When it does not
+// fit, the arbiter forgets it allowed the sound.
+bool SoundManager::startTrack(uint8_t sound) {
+    uint8_t kept = queueTail;
+    for (uint8_t i = queueTail; i != queueHead; i = (i + 1) & (SOUND_QUEUE_SIZE - 1)) {
+        if (queue[i].command == DFPLAYER_CMD_PLAY) continue;
+        queue[kept] = queue[i];
+        kept = (kept + 1) & (SOUND_QUEUE_SIZE - 1);
+    }
+    queueHead = kept;
+    if (!enqueue(DFPLAYER_CMD_PLAY, sound)) {
+        arbiter.notStarted();
+        return false;
+    }
+    return true;
+}
+
 void SoundManager::play(uint8_t sound) {
-    if (initialized) {
-        dfPlayer.play(sound);
+    PROFILE_SCOPE(PROBE_SOUND_PLAY);
+    if (initialized && arbiter.request(sound, millis())) {
+        queueVolume(volume);
+        startTrack(sound);
     }
 }
 
 
+// The volume stays with the module until the next play() puts ours back
 void SoundManager::playWithVolume(uint8_t sound, uint8_t vol) {
-    if (initialized) {
-        uint8_t originalVolume = dfPlayer.readVolume();
-        dfPlayer.volume(vol);
-        dfPlayer.play(sound);
-        dfPlayer.volume(originalVolume);
-    } else {
-        play(sound);
-    }
+    if (!initialized || !arbiter.request(sound, millis())) return;
+    queueVolume(constrain(vol, 0, 30));
+    startTrack(sound);
 }
 
 void SoundManager::setVolume(uint8_t vol) {
     volume = constrain(vol, 0, 30);
-    if (initialized) {
-        dfPlayer.volume(volume);
-    }
+    queueVolume(volume);
 }
 
 uint8_t SoundManager::getVolume() {
@@ -51,7 +236,24 @@ uint8_t SoundManager::getVolume() {
 }
 
 void SoundManager::stop() {
-    if (initialized) {
-        dfPlayer.stop();
-    }
-}
\ No newline at end of file
+    arbiter.stopped();
+    enqueue(DFPLAYER_CMD_STOP, 0);
+}
+
+void SoundManager::resetStats() {
+    tracksFinished = 0;
+    lastFinishedTrack = 0;
+    moduleErrors = 0;
+    lastError = 0;
+    rxBadFrames = 0;
+    arbiter.resetStats();
+}
+
+void SoundManager::printStats(Print& out) const {
+    char line[144];
+    FORMAT_TEXT(line, "dfplayer %s track %u volume %u finished %lu errors %lu (last %u) bad %lu queue dropped %lu",
+                playing ? "playing" : "idle", playingTrack, moduleVolume, tracksFinished,
+                moduleErrors, lastError, rxBadFrames, dropped);
+    out.println(line);
+    arbiter.printStats(out);
+}
@@ -0,0 +1,190 @@
+#include "ui_widgets.h"
+#include "display_manager.h"
+
+// TimerWidget implementation
+TimerWidget::TimerWidget(int16_t x, int16_t y, uint8_t size) : seconds(-1), x(x), y(y), size(size) {}
+
+void TimerWidget::set(int timeRemaining) {
+    if (timeRemaining != seconds) {
+        seconds = timeRemaining;
+        changed();
+    }
+}
+
+void TimerWidget::draw(DisplayManager& display) {
+    display.drawTimer(seconds, x, y, size);
+}
+
+// StatusBannerWidget implementation
+StatusBannerWidget::StatusBannerWidget() : armed(false) {}
+
+void StatusBannerWidget::set(bool isArmed) {
+    if (isArmed != armed) {
+        armed = isArmed;
+        changed();
+    }
+}
+
+void StatusBannerWidget::draw(DisplayManager& display) {
+    display.drawDefuseStatus(armed);
+}
+
+// DefuseResultWidget implementation
+DefuseResultWidget::DefuseResultWidget() : victory(false) {}
+
+void DefuseResultWidget::set(bool isVictory) {
+    if (isVictory != victory) {
+        victory = isVictory;
+        changed();
+    }
+}
+
+void DefuseResultWidget::draw(DisplayManager& display) {
+    display.drawGameOver(victory);
+}
+
+// CodeLineWidget implementation
+CodeLineWidget::CodeLineWidget() {
+    code[0] = '\0';
+}
+
+void CodeLineWidget::set(const int digits[], int count) {
+    count = constrain(count, 0, UI_CODE_MAX_LENGTH);
+    for (int i = 0; i < count; i++) {
+        char c = '0' + digits[i];
+        if (code[i] != c) {
+            code[i] = c;
+            changed();
+        }
+    }
+    if (code[count] != '\0') {
+        code[count] = '\0';
+        changed();
+    }
+}
+
+void CodeLineWidget::draw(DisplayManager& display) {
+    display.drawCodeLine(code);
+}
+
+// ScorePairWidget implementation
+ScorePairWidget::ScorePairWidget() : redScore(0), greenScore(0) {}
+
+void ScorePairWidget::set(int red, int green) {
+    if (red != redScore || green != greenScore) {
+        redScore = red;
+        greenScore = green;
+        changed();
+    }
+}
+
+void ScorePairWidget::draw(DisplayManager& display) {
+    display.drawScorePair(redScore, greenScore);
+}
+
+// FlagOwnerWidget implementation
+FlagOwnerWidget::FlagOwnerWidget() : owner(NEUTRAL) {}
+
+void FlagOwnerWidget::set(PointOwnership currentOwner) {
+    if (currentOwner != owner) {
+        owner = currentOwner;
+        changed();
+    }
+}
+
+void FlagOwnerWidget::draw(DisplayManager& display) {
+    display.drawFlagOwner(owner);
+}
+
+// CaptureBarWidget implementation
+CaptureBarWidget::CaptureBarWidget() : progress(0) {}
+
+void CaptureBarWidget::set(int captureProgress) {
+    if (captureProgress != progress) {
+        progress = captureProgress;
+        changed();
+    }
+}
+
+void CaptureBarWidget::draw(DisplayManager& display) {
+    display.drawCaptureBar(progress);
+}
+
+// SetupTimeWidget implementation
+SetupTimeWidget::SetupTimeWidget() : minutes(-1) {}
+
+void SetupTimeWidget::set(int gameMinutes) {
+    if (gameMinutes != minutes) {
+        minutes = gameMinutes;
+        changed();
+    }
+}
+
+void SetupTimeWidget::draw(DisplayManager& display) {
+    display.drawDominationSetup(minutes);
+}
+
+// DominationResultWidget implementation
+DominationResultWidget::DominationResultWidget() : winner(NEUTRAL), redScore(0), greenScore(0) {}
+
+void DominationResultWidget::set(PointOwnership matchWinner, int red, int green) {
+    if (matchWinner != winner || red != redScore || green != greenScore) {
+        winner = matchWinner;
+        redScore = red;
+        greenScore = green;
+        changed();
+    }
+}
+
+void DominationResultWidget::draw(DisplayManager& display) {
+    display.drawDominationGameOver(winner, redScore, greenScore);
+}
+
+// UiScreen implementation
+UiScreen::UiScreen() : widgetCount(0), lastFrame(0), renders(0) {}
+
+void UiScreen::add(UiWidget* widget) {
+    if (widgetCount < UI_MAX_WIDGETS) {
+        widgets[widgetCount++] = widget;
+    }
+}
+
+bool UiScreen::isDirty() const {
+    for (uint8_t i = 0; i < widgetCount; i++) {
+        if (widgets[i]->isDirty()) return true;
+    }
+    return false;
+}
+
+bool UiScreen::needsRender(const DisplayManager& display) const {
+    return display.getFrameCount() != lastFrame || isDirty();
+}
+
+void UiScreen::invalidate() {
+    for (uint8_t i = 0; i < widgetCount; i++) {
+        widgets[i]->markDirty();
+    }
+}
+
+bool UiScreen::render(DisplayManager& display) {
+    // Another screen (or a one-shot show* call) replaced our frame
+    if (display.getFrameCount() != lastFrame) {
+        invalidate();
+    }
+    
+    if (!isDirty()) return false;
+    
+    display.clear();
+    for (uint8_t i = 0; i < widgetCount; i++) {
+        widgets[i]->draw(display);
+        if (widgets[i]->getTraceId() != 0) {
+            TRACE_PIXELS_DRAWN(widgets[i]->getTraceId());
+        }
+        widgets[i]->markClean();
+    }
+    display.update();
+    
+    lastFrame = display.getFrameCount();
+    renders++;
+    return true;
+}
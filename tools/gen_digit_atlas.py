@@ -0,0 +1,97 @@
+"""Generate include/digit_atlas.h, the pre-scaled countdown digits.
+
+Adafruit_GFX draws scaled text one fillRect per font pixel, which makes the
+size 2/3 MM:SS timer the most expensive thing on every screen. This script
+scales the built-in 5x7 glyphs for '0'-'9' and ':' ahead of time and lays
+them out in SH1106 page order (one byte = 8 vertical pixels), so
+DisplayManager can copy them into the framebuffer byte by byte.
+
+Runs as a PlatformIO pre-build script (see platformio.ini) and can also be
+run by hand: python tools/gen_digit_atlas.py
+"""
+
+import os
+
+# Columns of the classic Adafruit_GFX glcdfont glyphs, LSB = top row
+FONT_5X7 = {
+    "0": [0x3E, 0x51, 0x49, 0x45, 0x3E],
+    "1": [0x00, 0x42, 0x7F, 0x40, 0x00],
+    "2": [0x72, 0x49, 0x49, 0x49, 0x46],
+    "3": [0x21, 0x41, 0x49, 0x4D, 0x33],
+    "4": [0x18, 0x14, 0x12, 0x7F, 0x10],
+    "5": [0x27, 0x45, 0x45, 0x45, 0x39],
+    "6": [0x3C, 0x4A, 0x49, 0x49, 0x31],
+    "7": [0x41, 0x21, 0x11, 0x09, 0x07],
+    "8": [0x36, 0x49, 0x49, 0x49, 0x36],
+    "9": [0x46, 0x49, 0x49, 0x29, 0x1E],
+    ":": [0x00, 0x00, 0x14, 0x00, 0x00],
+}
+GLYPHS = "0123456789:"
+SIZES = (2, 3)
+GLYPH_WIDTH = 6   # 5 pixel glyph + 1 pixel spacing, same advance as print()
+GLYPH_HEIGHT = 8
+
+
+def scale_glyph(columns, size):
+    """Return pages x (GLYPH_WIDTH * size) bytes of the glyph scaled by size."""
+    columns = columns + [0x00]  # spacing column
+    width = GLYPH_WIDTH * size
+    pages = size  # GLYPH_HEIGHT * size / 8
+    out = [[0] * width for _ in range(pages)]
+    for x in range(width):
+        source = columns[x // size]
+        for y in range(GLYPH_HEIGHT * size):
+            if source & (1 << (y // size)):
+                out[y // 8][x] |= 1 << (y % 8)
+    return out
+
+
+def render_header():
+    lines = [
+        "// Generated by tools/gen_digit_atlas.py - do not edit by hand",
+        "#ifndef DIGIT_ATLAS_H",
+        "#define DIGIT_ATLAS_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "// Pre-scaled '0'-'9' and ':' in SH1106 page layout: [glyph][page][column]",
+        "#define DIGIT_ATLAS_GLYPHS %d" % len(GLYPHS),
+        "#define DIGIT_ATLAS_COLON %d" % GLYPHS.index(":"),
+        "",
+    ]
+    for size in SIZES:
+        width = GLYPH_WIDTH * size
+        lines.append("static const uint8_t DIGIT_ATLAS_%dX[DIGIT_ATLAS_GLYPHS][%d][%d] PROGMEM = {"
+                     % (size, size, width))
+        for glyph in GLYPHS:
+            pages = scale_glyph(FONT_5X7[glyph], size)
+            lines.append("    { // '%s'" % glyph)
+            for page in pages:
+                lines.append("        {" + ", ".join("0x%02X" % b for b in page) + "},")
+            lines.append("    },")
+        lines.append("};")
+        lines.append("")
+    lines.append("#endif // DIGIT_ATLAS_H")
+    return "\n".join(lines) + "\n"
+
+
+def generate(project_dir):
+    path = os.path.join(project_dir, "include", "digit_atlas.h")
+    content = render_header()
+    try:
+        with open(path) as f:
+            if f.read() == content:
+                return  # Up to date, keep the timestamp so nothing rebuilds
+    except IOError:
+        pass
+    with open(path, "w") as f:
+        f.write(content)
+    print("Generated %s" % path)
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))